@@ -22,11 +22,27 @@ SOURCES+= $$PWD/src/Logging.cpp \
           $$PWD/src/NGLScene.cpp \
           $$PWD/src/NGLSceneMouseControls.cpp \
           $$PWD/src/Utilities.cpp \
-          $$PWD/src/Constraint.cpp \
-          $$PWD/src/MassPoint.cpp \
+          $$PWD/src/AdaptiveStepController.cpp \
+          $$PWD/src/BandedCholesky.cpp \
+          $$PWD/src/ConstraintStore.cpp \
+          $$PWD/src/FixedStepClock.cpp \
+          $$PWD/src/FlameInstances.cpp \
+          $$PWD/src/FlameBatch.cpp \
+          $$PWD/src/FlameMesh.cpp \
+          $$PWD/src/GridOrdering.cpp \
+          $$PWD/src/GridStencil.cpp \
+          $$PWD/src/ImplicitSolver.cpp \
           $$PWD/src/MassSpringObject.cpp \
-          $$PWD/src/Spring.cpp \
-          $$PWD/src/Timer.cpp
+          $$PWD/src/MeshIndices.cpp \
+          $$PWD/src/ParticleStore.cpp \
+          $$PWD/src/ProjectiveSolver.cpp \
+          $$PWD/src/SimdKernels.cpp \
+          $$PWD/src/Simulation.cpp \
+          $$PWD/src/SpringStore.cpp \
+          $$PWD/src/Stepper.cpp \
+          $$PWD/src/TaskScheduler.cpp \
+          $$PWD/src/Timer.cpp \
+          $$PWD/src/XpbdSolver.cpp
 
 # same for the .h files
 HEADERS+= $$PWD/include/CustomDefs.h \
@@ -35,11 +51,29 @@ HEADERS+= $$PWD/include/CustomDefs.h \
           $$PWD/include/NGLScene.h \
           $$PWD/include/Utilities.h \
           $$PWD/include/WindowParams.h \
-          $$PWD/include/Constraint.h \
-          $$PWD/include/MassPoint.h \
+          $$PWD/include/AdaptiveStepController.h \
+          $$PWD/include/BandedCholesky.h \
+          $$PWD/include/ConstraintStore.h \
+          $$PWD/include/FixedStepClock.h \
+          $$PWD/include/FlameInstances.h \
+          $$PWD/include/FlameBatch.h \
+          $$PWD/include/FlameMesh.h \
+          $$PWD/include/GridOrdering.h \
+          $$PWD/include/GridStencil.h \
+          $$PWD/include/ImplicitSolver.h \
           $$PWD/include/MassSpringObject.h \
-          $$PWD/include/Spring.h \
-          $$PWD/include/Timer.h
+          $$PWD/include/MeshIndices.h \
+          $$PWD/include/ParticleStore.h \
+          $$PWD/include/ProjectiveSolver.h \
+          $$PWD/include/SimdKernels.h \
+          $$PWD/include/Simulation.h \
+          $$PWD/include/SpscQueue.h \
+          $$PWD/include/SpringStore.h \
+          $$PWD/include/Stepper.h \
+          $$PWD/include/TaskScheduler.h \
+          $$PWD/include/Timer.h \
+          $$PWD/include/TripleBuffer.h \
+          $$PWD/include/XpbdSolver.h
 # and add the include dir into the search path for Qt and make
 INCLUDEPATH +=./include
 win32:INCLUDEPATH += $$(SDKs)/glm-0.9.9.3
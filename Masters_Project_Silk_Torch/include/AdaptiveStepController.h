@@ -0,0 +1,147 @@
+#ifndef ADAPTIVESTEPCONTROLLER_H_
+#define ADAPTIVESTEPCONTROLLER_H_
+
+#include <vector>
+#include <cstddef>
+#include "glm/glm.hpp"
+
+#include "ParticleStore.h"
+#include "SpringStore.h"
+#include "GridStencil.h"
+
+/// @file AdaptiveStepController.h
+/// @brief A Class that picks how many substeps the explicit solver needs to take a step safely.
+/// Two limits are estimated, the stiffness limit from the highest frequency of the springs and the velocity limit that
+/// stops a particle moving further than part of a spring length in one substep. The stiffness limit uses the
+/// Gershgorin bound of the largest eigenvalue of the mass weighted stiffness matrix, 2 / m * the sum of the spring
+/// constants at a particle, so it only changes with the springs and masses and is kept between steps.
+/// @author Jamie Slowgrove
+/// @version 1.1
+/// @date 31/08/19
+/// Revision History:
+/// Initial Version 27/08/19.
+/// Modified Version 31/08/19 to also take the springs of a GridStencil.
+class AdaptiveStepController
+{
+public:
+  /**
+  @brief Constructs an AdaptiveStepController with a safety factor of 0.5f, a maximum travel of 0.25f spring lengths
+  and at most 64 substeps.
+  */
+  AdaptiveStepController();
+
+  /**
+  @brief Destructs the AdaptiveStepController.
+  */
+  ~AdaptiveStepController();
+
+  /**
+  @brief Works out the number of substeps needed to take a step. The force accumulators of the particles are added to
+  the external force, they must not hold the spring forces.
+  @param[in] _springs The springs of the step.
+  @param[in] _particles The particles the springs are attached to.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time of the whole step.
+  @returns The number of substeps, at least 1.
+  */
+  unsigned int computeNumSubsteps(const SpringStore &_springs, const ParticleStore &_particles, glm::vec3 _externalForce, float _dt);
+
+  /**
+  @brief Works out the number of substeps needed to take a step with the springs of a GridStencil. The force
+  accumulators of the particles are added to the external force, they must not hold the spring forces.
+  @param[in] _stencil The stencil of the step.
+  @param[in] _particles The particles of the grids.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time of the whole step.
+  @returns The number of substeps, at least 1.
+  */
+  unsigned int computeNumSubsteps(const GridStencil &_stencil, const ParticleStore &_particles, glm::vec3 _externalForce, float _dt);
+
+  /**
+  @brief Marks the stiffness limit as out of date, this should be called when the springs or masses change.
+  */
+  void invalidate();
+
+  /**
+  @brief Gets the number of substeps picked by the last call to computeNumSubsteps.
+  @returns The number of substeps.
+  */
+  unsigned int getNumSubsteps() const;
+
+  /**
+  @brief Gets the largest stable substep found by the last call to computeNumSubsteps.
+  @returns The stable delta time.
+  */
+  float getStableDt() const;
+
+  /**
+  @brief Sets the most substeps a step can be split into.
+  @param[in] _maxSubsteps The maximum number of substeps.
+  */
+  void setMaxSubsteps(unsigned int _maxSubsteps);
+
+  /**
+  @brief Gets the most substeps a step can be split into.
+  @returns The maximum number of substeps.
+  */
+  unsigned int getMaxSubsteps() const;
+
+  /**
+  @brief Sets the fraction of the stiffness limit a substep may use.
+  @param[in] _safetyFactor The safety factor, between 0 and 1.
+  */
+  void setSafetyFactor(float _safetyFactor);
+
+  /**
+  @brief Sets the fraction of the shortest spring a particle may move in one substep.
+  @param[in] _maxTravel The maximum travel.
+  */
+  void setMaxTravel(float _maxTravel);
+
+private:
+  ///The largest eigenvalue estimate of the mass weighted stiffness matrix.
+  float m_maxFrequencySquared;
+  ///The rest length of the shortest spring.
+  float m_minRestLength;
+  ///A flag for if the stiffness limit matches the current springs and masses.
+  bool m_built;
+  ///The number of particles the stiffness limit was found for.
+  std::size_t m_builtParticles;
+  ///The number of springs the stiffness limit was found for.
+  std::size_t m_builtSprings;
+  ///The number of substeps picked by the last call to computeNumSubsteps.
+  unsigned int m_numSubsteps;
+  ///The largest stable substep found by the last call to computeNumSubsteps.
+  float m_stableDt;
+  ///The most substeps a step can be split into.
+  unsigned int m_maxSubsteps;
+  ///The fraction of the stiffness limit a substep may use.
+  float m_safetyFactor;
+  ///The fraction of the shortest spring a particle may move in one substep.
+  float m_maxTravel;
+
+  /**
+  @brief Finds the stiffness limit and the shortest spring.
+  @param[in] _springs The springs of the step.
+  @param[in] _particles The particles the springs are attached to.
+  */
+  void build(const SpringStore &_springs, const ParticleStore &_particles);
+
+  /**
+  @brief Finds the stiffness limit from the sum of the spring constants at each particle.
+  @param[in] _stiffness The sum of the spring constants at each particle.
+  @param[in] _particles The particles the springs are attached to.
+  */
+  void build(const std::vector<float> &_stiffness, const ParticleStore &_particles);
+
+  /**
+  @brief Works out the number of substeps from the stiffness limit and the velocity limit.
+  @param[in] _particles The particles of the step.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time of the whole step.
+  @returns The number of substeps, at least 1.
+  */
+  unsigned int pickNumSubsteps(const ParticleStore &_particles, glm::vec3 _externalForce, float _dt);
+};
+
+#endif // ADAPTIVESTEPCONTROLLER_H_
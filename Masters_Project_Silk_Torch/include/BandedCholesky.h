@@ -0,0 +1,99 @@
+#ifndef BANDEDCHOLESKY_H_
+#define BANDEDCHOLESKY_H_
+
+#include <vector>
+#include <cstddef>
+
+/// @file BandedCholesky.h
+/// @brief A Class that factors a symmetric positive definite banded matrix into L * L^T and solves with the factor.
+/// Only the lower band is stored, each row is contiguous so the factorisation and the triangular solves stream
+/// through memory. The cost of the factorisation is size * bandwidth^2 and each solve is size * bandwidth.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 23/08/19
+/// Revision History:
+/// Initial Version 23/08/19.
+class BandedCholesky
+{
+public:
+  /**
+  @brief Constructs an empty BandedCholesky.
+  */
+  BandedCholesky();
+
+  /**
+  @brief Destructs the BandedCholesky.
+  */
+  ~BandedCholesky();
+
+  /**
+  @brief Resizes the matrix and sets every value to zero.
+  @param[in] _size The number of rows and columns.
+  @param[in] _bandwidth The number of values below the diagonal in each row.
+  */
+  void resize(std::size_t _size, std::size_t _bandwidth);
+
+  /**
+  @brief Adds a value to the lower band of the matrix, the upper band is the mirror of it.
+  @param[in] _row The row of the value, this must not be less than the column.
+  @param[in] _column The column of the value.
+  @param[in] _value The value to add.
+  */
+  void add(std::size_t _row, std::size_t _column, double _value);
+
+  /**
+  @brief Replaces the matrix with its Cholesky factor.
+  @returns False if the matrix is not positive definite.
+  */
+  bool factorise();
+
+  /**
+  @brief Solves the system using the Cholesky factor, factorise must have been called.
+  @param[in,out] _x The right hand side, replaced with the solution.
+  */
+  void solve(std::vector<double> &_x) const;
+
+  /**
+  @brief Gets the number of rows and columns of the matrix.
+  @returns The size of the matrix.
+  */
+  std::size_t size() const;
+
+  /**
+  @brief Gets the number of values below the diagonal in each row.
+  @returns The bandwidth of the matrix.
+  */
+  std::size_t getBandwidth() const;
+
+private:
+  ///The number of rows and columns.
+  std::size_t m_size;
+  ///The number of values below the diagonal in each row.
+  std::size_t m_bandwidth;
+  ///The lower band stored row by row, the diagonal is the last value of each row.
+  std::vector<double> m_band;
+
+  /**
+  @brief Gets the index of a value of the lower band.
+  @param[in] _row The row of the value.
+  @param[in] _column The column of the value.
+  @returns The index of the value in m_band.
+  */
+  std::size_t getIndex(std::size_t _row, std::size_t _column) const;
+
+  /**
+  @brief Gets a row of the lower band, offset so the value in a column is indexed by the column.
+  @param[in] _row The row.
+  @returns A pointer that gives the value in column k at index k, only the columns inside the band are valid.
+  */
+  double *getRow(std::size_t _row);
+
+  /**
+  @brief Gets a row of the lower band, offset so the value in a column is indexed by the column.
+  @param[in] _row The row.
+  @returns A pointer that gives the value in column k at index k, only the columns inside the band are valid.
+  */
+  const double *getRow(std::size_t _row) const;
+};
+
+#endif // BANDEDCHOLESKY_H_
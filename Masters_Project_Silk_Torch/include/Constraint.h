@@ -1,26 +0,0 @@
-#ifndef CONSTRAINT_H_
-#define CONSTRAINT_H_
-
-/// @file Constraint.h
-/// @brief A Class that contains all the functions and members that are related in making a Constraint.
-/// @author Jamie Slowgrove
-/// @version 1.0
-/// @date 03/08/19
-/// Revision History:
-/// Initial Version 03/08/19.
-class Constraint
-{
-public:
-  /**
-  @brief Constructs the Constraint.
-  */
-  Constraint() = default;
-  /**
-  @brief Destructs the Constraint.
-  */
-  ~Constraint();
-
-private:
-};
-
-#endif // CONSTRAINT_H_
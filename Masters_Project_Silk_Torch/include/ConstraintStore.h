@@ -0,0 +1,209 @@
+#ifndef CONSTRAINTSTORE_H_
+#define CONSTRAINTSTORE_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "glm/glm.hpp"
+
+#include "ParticleStore.h"
+
+/// @file ConstraintStore.h
+/// @brief A Class that contains the position based constraints of a mass spring object and projects them with XPBD.
+/// Each type of constraint lives in its own flat arrays, the distance and bending constraints are sorted into colour
+/// batches that share no particles so a batch can be projected across threads with Gauss-Seidel.
+/// @author Jamie Slowgrove
+/// @version 2.0
+/// @date 24/08/19
+/// Revision History:
+/// Initial Version 03/08/19.
+/// New Version 24/08/19 as a store of distance, pin and bending constraints, replacing the empty Constraint class.
+class ConstraintStore
+{
+public:
+  /**
+  @brief Constructs an empty ConstraintStore.
+  */
+  ConstraintStore();
+
+  /**
+  @brief Destructs the ConstraintStore.
+  */
+  ~ConstraintStore();
+
+  /**
+  @brief Removes all of the constraints from the ConstraintStore.
+  */
+  void clear();
+
+  /**
+  @brief Adds a constraint that keeps two particles at a distance.
+  @param[in] _pointA The index of the first particle.
+  @param[in] _pointB The index of the second particle.
+  @param[in] _restLength The distance between the particles.
+  @param[in] _compliance The inverse stiffness of the constraint, 0 for a rigid constraint.
+  */
+  void addDistance(std::uint32_t _pointA, std::uint32_t _pointB, float _restLength, float _compliance);
+
+  /**
+  @brief Adds a constraint that keeps a particle at a position.
+  @param[in] _point The index of the particle.
+  @param[in] _position The position to keep the particle at.
+  @param[in] _compliance The inverse stiffness of the constraint, 0 for a rigid constraint.
+  */
+  void addPin(std::uint32_t _point, glm::vec3 _position, float _compliance);
+
+  /**
+  @brief Adds a constraint that keeps the middle of three particles at a distance from their centre.
+  @param[in] _pointA The index of the first outer particle.
+  @param[in] _pointB The index of the middle particle.
+  @param[in] _pointC The index of the second outer particle.
+  @param[in] _restLength The distance of the middle particle from the centre, 0 for a straight line.
+  @param[in] _compliance The inverse stiffness of the constraint, 0 for a rigid constraint.
+  */
+  void addBending(std::uint32_t _pointA, std::uint32_t _pointB, std::uint32_t _pointC, float _restLength, float _compliance);
+
+  /**
+  @brief Gets the number of distance constraints.
+  @returns The number of distance constraints.
+  */
+  std::size_t getNumDistances() const;
+
+  /**
+  @brief Gets the number of pin constraints.
+  @returns The number of pin constraints.
+  */
+  std::size_t getNumPins() const;
+
+  /**
+  @brief Gets the number of bending constraints.
+  @returns The number of bending constraints.
+  */
+  std::size_t getNumBendings() const;
+
+  /**
+  @brief Sets the compliance of every distance constraint.
+  @param[in] _compliance The inverse stiffness.
+  */
+  void setDistanceCompliance(float _compliance);
+
+  /**
+  @brief Sets the compliance of every bending constraint.
+  @param[in] _compliance The inverse stiffness.
+  */
+  void setBendingCompliance(float _compliance);
+
+  /**
+  @brief Sorts the distance and bending constraints into colour batches where no two constraints in a batch share a
+  particle. Adding a constraint removes the batches.
+  */
+  void buildColourBatches();
+
+  /**
+  @brief Gets the number of distance colour batches.
+  @returns The number of batches, 0 if the constraints have not been coloured.
+  */
+  std::size_t getNumDistanceColours() const;
+
+  /**
+  @brief Gets the index of the first distance constraint in a colour batch.
+  @param[in] _colour The colour of the batch.
+  @returns The index of the first constraint.
+  */
+  std::size_t getDistanceColourBegin(std::size_t _colour) const;
+
+  /**
+  @brief Gets the index after the last distance constraint in a colour batch.
+  @param[in] _colour The colour of the batch.
+  @returns The index after the last constraint.
+  */
+  std::size_t getDistanceColourEnd(std::size_t _colour) const;
+
+  /**
+  @brief Gets the number of bending colour batches.
+  @returns The number of batches, 0 if the constraints have not been coloured.
+  */
+  std::size_t getNumBendingColours() const;
+
+  /**
+  @brief Gets the index of the first bending constraint in a colour batch.
+  @param[in] _colour The colour of the batch.
+  @returns The index of the first constraint.
+  */
+  std::size_t getBendingColourBegin(std::size_t _colour) const;
+
+  /**
+  @brief Gets the index after the last bending constraint in a colour batch.
+  @param[in] _colour The colour of the batch.
+  @returns The index after the last constraint.
+  */
+  std::size_t getBendingColourEnd(std::size_t _colour) const;
+
+  /**
+  @brief Resets the accumulated Lagrange multipliers, this is done at the start of each step.
+  */
+  void resetLambdas();
+
+  /**
+  @brief Projects a range of the distance constraints.
+  @param[in,out] _particles The particles.
+  @param[in] _dt The delta time.
+  @param[in] _begin The index of the first constraint to project.
+  @param[in] _end The index after the last constraint to project.
+  */
+  void solveDistances(ParticleStore &_particles, float _dt, std::size_t _begin, std::size_t _end);
+
+  /**
+  @brief Projects a range of the bending constraints.
+  @param[in,out] _particles The particles.
+  @param[in] _dt The delta time.
+  @param[in] _begin The index of the first constraint to project.
+  @param[in] _end The index after the last constraint to project.
+  */
+  void solveBendings(ParticleStore &_particles, float _dt, std::size_t _begin, std::size_t _end);
+
+  /**
+  @brief Projects all of the pin constraints.
+  @param[in,out] _particles The particles.
+  @param[in] _dt The delta time.
+  */
+  void solvePins(ParticleStore &_particles, float _dt);
+
+private:
+  ///The first particle of each distance constraint.
+  std::vector<std::uint32_t> m_distanceA;
+  ///The second particle of each distance constraint.
+  std::vector<std::uint32_t> m_distanceB;
+  ///The rest length of each distance constraint.
+  std::vector<float> m_distanceRestLength;
+  ///The compliance of each distance constraint.
+  std::vector<float> m_distanceCompliance;
+  ///The accumulated Lagrange multiplier of each distance constraint.
+  std::vector<float> m_distanceLambda;
+  ///The index of the first distance constraint in each colour batch followed by the number of distance constraints.
+  std::vector<std::size_t> m_distanceColourOffsets;
+  ///The particle of each pin constraint.
+  std::vector<std::uint32_t> m_pinPoint;
+  ///The position of each pin constraint.
+  std::vector<glm::vec3> m_pinPosition;
+  ///The compliance of each pin constraint.
+  std::vector<float> m_pinCompliance;
+  ///The accumulated Lagrange multiplier of each pin constraint.
+  std::vector<float> m_pinLambda;
+  ///The first outer particle of each bending constraint.
+  std::vector<std::uint32_t> m_bendingA;
+  ///The middle particle of each bending constraint.
+  std::vector<std::uint32_t> m_bendingB;
+  ///The second outer particle of each bending constraint.
+  std::vector<std::uint32_t> m_bendingC;
+  ///The rest length of each bending constraint.
+  std::vector<float> m_bendingRestLength;
+  ///The compliance of each bending constraint.
+  std::vector<float> m_bendingCompliance;
+  ///The accumulated Lagrange multiplier of each bending constraint.
+  std::vector<float> m_bendingLambda;
+  ///The index of the first bending constraint in each colour batch followed by the number of bending constraints.
+  std::vector<std::size_t> m_bendingColourOffsets;
+};
+
+#endif // CONSTRAINTSTORE_H_
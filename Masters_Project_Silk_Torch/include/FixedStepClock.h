@@ -0,0 +1,93 @@
+#ifndef FIXEDSTEPCLOCK_H_
+#define FIXEDSTEPCLOCK_H_
+
+/// @file FixedStepClock.h
+/// @brief A Class that turns the varying frame times into a whole number of fixed simulation steps.
+/// The frame time is added to an accumulator and a step is taken for every full step size in it, what is left over is
+/// used to blend between the last two simulated states when drawing. The number of steps in one frame is capped so a
+/// slow frame cannot make the next frame slower still, the time that could not be caught up with is dropped.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 26/08/19
+/// Revision History:
+/// Initial Version 26/08/19.
+class FixedStepClock
+{
+public:
+  /**
+  @brief Constructs a FixedStepClock that steps at 60Hz and takes at most 5 steps a frame.
+  */
+  FixedStepClock();
+
+  /**
+  @brief Constructs a FixedStepClock.
+  @param[in] _stepSize The size of a simulation step in seconds.
+  @param[in] _maxSteps The most steps that can be taken in one frame.
+  */
+  FixedStepClock(float _stepSize, unsigned int _maxSteps);
+
+  /**
+  @brief Destructs the FixedStepClock.
+  */
+  ~FixedStepClock();
+
+  /**
+  @brief Adds the time of a frame to the accumulator and takes out the steps it covers.
+  @param[in] _frameTime The time since the last frame in seconds.
+  @returns The number of simulation steps to take this frame.
+  */
+  unsigned int advance(float _frameTime);
+
+  /**
+  @brief Gets how far the accumulator is between the last simulated state and the next one.
+  @returns The blend from the previous state at 0 to the current state at 1.
+  */
+  float getAlpha() const;
+
+  /**
+  @brief Empties the accumulator, used when the simulated state is reset.
+  */
+  void reset();
+
+  /**
+  @brief Gets the size of a simulation step.
+  @returns The step size in seconds.
+  */
+  float getStepSize() const;
+
+  /**
+  @brief Sets the size of a simulation step.
+  @param[in] _stepSize The step size in seconds.
+  */
+  void setStepSize(float _stepSize);
+
+  /**
+  @brief Gets the most steps that can be taken in one frame.
+  @returns The maximum number of steps.
+  */
+  unsigned int getMaxSteps() const;
+
+  /**
+  @brief Sets the most steps that can be taken in one frame.
+  @param[in] _maxSteps The maximum number of steps.
+  */
+  void setMaxSteps(unsigned int _maxSteps);
+
+  /**
+  @brief Gets the number of frames that had time dropped because they hit the step cap.
+  @returns The number of frames that fell behind.
+  */
+  unsigned int getNumDroppedFrames() const;
+
+private:
+  ///The time that has not been simulated yet.
+  float m_accumulator;
+  ///The size of a simulation step.
+  float m_stepSize;
+  ///The most steps that can be taken in one frame.
+  unsigned int m_maxSteps;
+  ///The number of frames that hit the step cap.
+  unsigned int m_numDroppedFrames;
+};
+
+#endif // FIXEDSTEPCLOCK_H_
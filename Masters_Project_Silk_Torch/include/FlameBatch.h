@@ -0,0 +1,192 @@
+#ifndef FLAMEBATCH_H_
+#define FLAMEBATCH_H_
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "glm/glm.hpp"
+
+#include "MassSpringObject.h"
+#include "ParticleStore.h"
+#include "SpringStore.h"
+#include "ImplicitSolver.h"
+#include "ProjectiveSolver.h"
+#include "XpbdSolver.h"
+#include "Stepper.h"
+#include "AdaptiveStepController.h"
+#include "GridStencil.h"
+
+/// @file FlameBatch.h
+/// @brief A Class that packs every flame of a scene into one shared particle and spring buffer so they are all stepped
+/// by a single pass of the kernels. Each flame owns a range of the shared buffers and keeps its own wind impulse.
+/// Small flames are too small to vectorise or split across threads on their own, batched they behave like one big grid.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 21/08/19
+/// Revision History:
+/// Initial Version 21/08/19.
+class FlameBatch
+{
+public:
+  /**
+  @brief Constructs an empty FlameBatch.
+  */
+  FlameBatch();
+
+  /**
+  @brief Destructs the FlameBatch.
+  */
+  ~FlameBatch();
+
+  /**
+  @brief Packs the current state of the flames into the shared buffers. The springs take the damping of the first flame
+  and every flame must have the same grid size. The grid stencil solver uses the springs of the first flame for all of
+  them.
+  @param[in] _flames The flames to batch.
+  */
+  void build(const std::vector<std::shared_ptr<MassSpringObject>> &_flames);
+
+  /**
+  @brief Empties the FlameBatch without copying its state back to the flames.
+  */
+  void clear();
+
+  /**
+  @brief Gets if the FlameBatch has no flames.
+  @returns True if there are no flames in the FlameBatch.
+  */
+  bool isEmpty() const;
+
+  /**
+  @brief Copies the positions and velocities in the shared buffer back to the flames so they can be stepped on their own again.
+  */
+  void writeBack();
+
+  /**
+  @brief Steps every flame in the FlameBatch and updates the vertices of the flames.
+  @param[in] _dt The delta time.
+  */
+  void update(float _dt);
+
+  /**
+  @brief Sets the mass of the points of every flame.
+  @param[in] _mass The mass of the points.
+  */
+  void setMass(float _mass);
+
+  /**
+  @brief Sets the constant of the springs of every flame, the flames must have been given it first as the shared
+  springs take their materials from them.
+  @param[in] _springConstant The spring constant.
+  */
+  void setSpringConstant(float _springConstant);
+
+  /**
+  @brief Sets the damping of the springs of every flame.
+  @param[in] _damping The damping value.
+  */
+  void setDamping(float _damping);
+
+  /**
+  @brief Sets the rest length of the springs of every flame, the flames must have been given it first as the shared
+  springs take their materials from them.
+  @param[in] _restLength The spring rest length.
+  */
+  void setRestLength(float _restLength);
+
+  /**
+  @brief Sets how much stiffer the springs at the base of every flame are than the rest, the flames must have been
+  given it first as the shared springs take their materials from them.
+  @param[in] _baseStiffness The spring constant of the base as a multiple of the spring constant.
+  */
+  void setBaseStiffness(float _baseStiffness);
+
+  /**
+  @brief Sets the solver the FlameBatch is integrated with.
+  @param[in] _solverType The type of solver.
+  */
+  void setSolverType(SolverType _solverType);
+
+  /**
+  @brief Sets the integrator and precision of the explicit solver.
+  @param[in] _integratorType The integrator.
+  @param[in] _doublePrecision True to step in double precision, false for float.
+  */
+  void setIntegrator(IntegratorType _integratorType, bool _doublePrecision);
+
+  /**
+  @brief Sets if the grid stencil solver steps its substeps a band of the shared grids at a time.
+  @param[in] _blockedSubsteps True to step the substeps in bands.
+  */
+  void setBlockedSubsteps(bool _blockedSubsteps);
+
+  /**
+  @brief Gets the number of substeps the explicit solver split the last step into.
+  @returns The number of substeps, 1 for the other solvers.
+  */
+  unsigned int getNumSubsteps() const;
+
+  /**
+  @brief Gets the shared particles of the FlameBatch.
+  @returns A reference to the shared ParticleStore, this is valid until the next build or clear.
+  */
+  const ParticleStore &getParticles() const;
+
+  /**
+  @brief Gets the index of the first point of a flame in the shared particles.
+  @param[in] _flameIndex The index of the flame.
+  @returns The index of the first point.
+  */
+  std::size_t getParticleOffset(std::size_t _flameIndex) const;
+
+private:
+  ///The flames in the FlameBatch.
+  std::vector<std::shared_ptr<MassSpringObject>> m_flames;
+  ///The index of the first point of each flame followed by the total number of points.
+  std::vector<std::size_t> m_particleOffsets;
+  ///The external force of each flame for the current step.
+  std::vector<glm::vec3> m_externalForces;
+  ///The shared particles of every flame.
+  ParticleStore m_particles;
+  ///The shared springs of every flame.
+  SpringStore m_springs;
+  ///The stencil that finds the springs of every flame from the grids, used in place of the shared springs by the grid
+  ///stencil solver.
+  GridStencil m_stencil;
+  ///The solver the shared particles are integrated with.
+  SolverType m_solverType;
+  ///The implicit backward Euler solver.
+  ImplicitSolver m_implicitSolver;
+  ///The projective dynamics solver.
+  ProjectiveSolver m_projectiveSolver;
+  ///The position based dynamics solver.
+  XpbdSolver m_xpbdSolver;
+  ///The integrator of the explicit solver.
+  IntegratorType m_integratorType;
+  ///A flag for if the explicit solver steps in double precision.
+  bool m_doublePrecision;
+  ///A flag for if the grid stencil solver steps its substeps in bands.
+  bool m_blockedSubsteps;
+  ///The explicit solver.
+  std::unique_ptr<AbstractStepper> m_stepper;
+  ///The controller that splits the explicit steps into substeps when they would be unstable.
+  AdaptiveStepController m_stepController;
+
+  /**
+  @brief Empties the force accumulators and fills them with the external force of each flame.
+  */
+  void applyExternalForces();
+
+  /**
+  @brief Packs the springs of every flame into the shared springs.
+  */
+  void buildSprings();
+
+  /**
+  @brief Copies the spring materials of the first flame to the shared springs, the materials keep their indices when
+  the springs are packed so every flame uses the same ones.
+  */
+  void copyMaterials();
+};
+
+#endif // FLAMEBATCH_H_
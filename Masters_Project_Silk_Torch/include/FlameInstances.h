@@ -0,0 +1,88 @@
+#ifndef FLAMEINSTANCES_H_
+#define FLAMEINSTANCES_H_
+
+#include <vector>
+#include <cstdint>
+#include <ngl/Types.h>
+
+#include "Simulation.h"
+
+/// @file FlameInstances.h
+/// @brief A Class that draws every flame of a snapshot with one instanced draw call.
+/// The flames are all generated from the same grid size and particle order, so they share one index buffer and one
+/// uv buffer. The positions of every flame are packed one flame after the other into a texture buffer, and the vertex
+/// shader fetches its position with the instance and vertex ids. The transform and texture layer of each flame are
+/// per instance attributes, so nothing changes between the flames and the whole scene is one glDrawElementsInstanced.
+/// Only the drawing thread may use a FlameInstances as it needs the GL context.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 04/09/19
+/// Revision History:
+/// Initial Version 04/09/19.
+class FlameInstances
+{
+public:
+  /**
+  @brief Constructs a FlameInstances and creates its vertex array, buffers and texture buffer.
+  */
+  FlameInstances();
+
+  /**
+  @brief Destructs the FlameInstances and deletes its vertex array, buffers and texture buffer.
+  */
+  ~FlameInstances();
+
+  /**
+  @brief Uploads the parts of the flames that have changed.
+  @param[in] _snapshot The snapshot of the flames.
+  @param[in] _positionsChanged True if the positions are new since the last update.
+  @param[in] _solidLayer The texture layer to draw every flame with, -1 to use the texture of each flame.
+  @returns False if the flames do not share a mesh or are too big for the texture buffer, they must then be drawn one at
+  a time.
+  */
+  bool update(const FrameSnapshot &_snapshot, bool _positionsChanged, int _solidLayer);
+
+  /**
+  @brief Draws every flame, the positions are bound to texture unit 1.
+  */
+  void draw() const;
+
+  /**
+  @brief Gets the number of vertices of each flame, the shader needs it to find the positions of an instance.
+  @returns The number of vertices.
+  */
+  GLint getNumVertices() const;
+
+  ///The number of floats for each instance, the transform and the texture layer.
+  static const std::size_t c_instanceSize = 17;
+
+private:
+  ///The vertex array.
+  GLuint m_vao;
+  ///The buffer of the positions of every flame.
+  GLuint m_positionBuffer;
+  ///The texture buffer the shader reads the positions through.
+  GLuint m_positionTexture;
+  ///The buffer of the shared uv's, attribute 2.
+  GLuint m_uvBuffer;
+  ///The buffer of the shared indices.
+  GLuint m_indexBuffer;
+  ///The buffer of the transform and texture layer of each instance, attributes 3 to 7.
+  GLuint m_instanceBuffer;
+  ///The version of the mesh of the first flame, the uv's and indices in the buffers are its.
+  std::uint64_t m_meshVersion;
+  ///The number of indices to draw.
+  GLsizei m_numIndices;
+  ///The type of the indices, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+  GLenum m_indexType;
+  ///The number of vertices of each flame.
+  GLint m_numVertices;
+  ///The number of flames to draw.
+  GLsizei m_numInstances;
+  ///The most texels the texture buffer can hold.
+  GLint m_maxTexels;
+  ///The instance data of every flame, kept so its memory is reused.
+  std::vector<float> m_instanceData;
+};
+
+#endif // FLAMEINSTANCES_H_
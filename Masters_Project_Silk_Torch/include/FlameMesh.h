@@ -0,0 +1,62 @@
+#ifndef FLAMEMESH_H_
+#define FLAMEMESH_H_
+
+#include <cstdint>
+#include <ngl/Types.h>
+
+#include "Simulation.h"
+
+/// @file FlameMesh.h
+/// @brief A Class that keeps the OpenGL buffers of one flame between frames.
+/// The uv's and indices only change when a flame is generated, so they are uploaded once into static buffers and
+/// uploaded again only when the mesh version of the snapshot changes. The positions change every step so they have a
+/// buffer of their own that is orphaned before each upload, the driver hands back fresh memory instead of waiting for
+/// the last frame to finish drawing from it. Only the drawing thread may use a FlameMesh as it needs the GL context.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 03/09/19
+/// Revision History:
+/// Initial Version 03/09/19.
+class FlameMesh
+{
+public:
+  /**
+  @brief Constructs a FlameMesh and creates its vertex array and buffers.
+  */
+  FlameMesh();
+
+  /**
+  @brief Destructs the FlameMesh and deletes its vertex array and buffers.
+  */
+  ~FlameMesh();
+
+  /**
+  @brief Uploads the parts of a flame that have changed.
+  @param[in] _flame The snapshot of the flame.
+  @param[in] _positionsChanged True if the positions are new since the last update.
+  */
+  void update(const FlameSnapshot &_flame, bool _positionsChanged);
+
+  /**
+  @brief Draws the flame as a series of GL_TRIANGLES.
+  */
+  void draw() const;
+
+private:
+  ///The vertex array.
+  GLuint m_vao;
+  ///The buffer of the positions, attribute 0.
+  GLuint m_positionBuffer;
+  ///The buffer of the uv's, attribute 2.
+  GLuint m_uvBuffer;
+  ///The buffer of the indices.
+  GLuint m_indexBuffer;
+  ///The version of the uv's and indices in the buffers, 0 before the first upload.
+  std::uint64_t m_meshVersion;
+  ///The number of indices to draw.
+  GLsizei m_numIndices;
+  ///The type of the indices, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+  GLenum m_indexType;
+};
+
+#endif // FLAMEMESH_H_
@@ -0,0 +1,105 @@
+#ifndef GRIDORDERING_H_
+#define GRIDORDERING_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/// @file GridOrdering.h
+/// @brief A Class that maps the points of a square grid to the order their particles are stored in.
+/// In row major order the point above a point is a whole row away, so on big grids every vertical spring misses the
+/// cache. The tiled order stores the grid in small square tiles and the Morton order follows the Z-order curve, both
+/// keep the points around a point close together in memory. The indices, uv's and springs are generated through the
+/// ordering so the mesh and the simulation are the same whatever the order.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 02/09/19
+/// Revision History:
+/// Initial Version 02/09/19.
+
+/**
+@brief The orders the points of a square grid can be stored in.
+*/
+enum class ParticleOrder
+{
+  ROW_MAJOR,
+  TILED,
+  MORTON
+};
+
+class GridOrdering
+{
+public:
+  /**
+  @brief Constructs an empty GridOrdering in row major order.
+  */
+  GridOrdering();
+
+  /**
+  @brief Destructs the GridOrdering.
+  */
+  ~GridOrdering();
+
+  /**
+  @brief Builds the ordering of a grid.
+  @param[in] _gridSize The number of points along each side of the grid.
+  @param[in] _order The order to store the points in.
+  */
+  void build(unsigned int _gridSize, ParticleOrder _order);
+
+  /**
+  @brief Gets the order the points are stored in.
+  @returns The order of the points.
+  */
+  ParticleOrder getOrder() const;
+
+  /**
+  @brief Gets the index of the particle of a point of the grid.
+  @param[in] _x The column of the point.
+  @param[in] _y The row of the point.
+  @returns The index of the particle.
+  */
+  std::uint32_t getIndex(unsigned int _x, unsigned int _y) const;
+
+  /**
+  @brief Gets the point of the grid a particle belongs to.
+  @param[in] _index The index of the particle.
+  @returns The row major index of the point, y * gridSize + x.
+  */
+  std::uint32_t getPoint(std::size_t _index) const;
+
+  /**
+  @brief Gets the point of the grid every particle belongs to.
+  @returns A reference to the row major index of the point of each particle, this is valid until the next build.
+  */
+  const std::vector<std::uint32_t> &getPoints() const;
+
+  ///The number of points along each side of a tile in the tiled order, a tile of floats fills four cache lines.
+  static const unsigned int c_tileSize = 8;
+
+private:
+  ///The number of points along each side of the grid.
+  unsigned int m_gridSize;
+  ///The order the points are stored in.
+  ParticleOrder m_order;
+  ///The index of the particle of each point, in row major order.
+  std::vector<std::uint32_t> m_indices;
+  ///The row major index of the point of each particle.
+  std::vector<std::uint32_t> m_points;
+
+  /**
+  @brief Stores the next particle at a point of the grid.
+  @param[in] _x The column of the point.
+  @param[in] _y The row of the point.
+  */
+  void addPoint(unsigned int _x, unsigned int _y);
+
+  /**
+  @brief Spreads the bits of a number out so there is a zero between each one, for the Morton order.
+  @param[in] _value The number to spread.
+  @returns The spread number.
+  */
+  static std::uint64_t spreadBits(std::uint32_t _value);
+};
+
+#endif // GRIDORDERING_H_
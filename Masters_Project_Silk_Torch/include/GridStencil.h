@@ -0,0 +1,223 @@
+#ifndef GRIDSTENCIL_H_
+#define GRIDSTENCIL_H_
+
+#include <vector>
+#include <cstddef>
+
+#include "ParticleStore.h"
+
+/// @file GridStencil.h
+/// @brief A Class that computes the spring forces of square grids of particles without a stored spring list.
+/// The particles of each grid are stored row by row and the grids one after the other, so the neighbours of a
+/// particle are found from fixed index offsets. The structural springs join the neighbours along the rows and columns,
+/// the shear springs join the diagonal neighbours and the bend springs join the particles two apart along the rows and
+/// columns. Each particle gathers the force of every spring attached to it, so a spring is worked out from both ends
+/// but every row only writes its own forces and the rows can be computed in any order.
+/// @author Jamie Slowgrove
+/// @version 1.1
+/// @date 02/09/19
+/// Revision History:
+/// Initial Version 31/08/19.
+/// Modified Version 02/09/19 to step several substeps a band of rows at a time.
+class GridStencil
+{
+public:
+  /**
+  @brief Constructs an empty GridStencil with only the structural springs.
+  */
+  GridStencil();
+
+  /**
+  @brief Destructs the GridStencil.
+  */
+  ~GridStencil();
+
+  /**
+  @brief Sets the size and number of the grids.
+  @param[in] _gridSize The number of particles along each side of a grid.
+  @param[in] _numGrids The number of grids stored one after the other.
+  */
+  void setGrid(unsigned int _gridSize, std::size_t _numGrids);
+
+  /**
+  @brief Gets the number of particles along each side of a grid.
+  @returns The size of a grid.
+  */
+  unsigned int getGridSize() const;
+
+  /**
+  @brief Gets the number of grids.
+  @returns The number of grids.
+  */
+  std::size_t getNumGrids() const;
+
+  /**
+  @brief Sets the spring constant of the springs.
+  @param[in] _stiffness The spring constant.
+  */
+  void setStiffness(float _stiffness);
+
+  /**
+  @brief Gets the spring constant of the springs.
+  @returns The spring constant.
+  */
+  float getStiffness() const;
+
+  /**
+  @brief Sets how much stiffer the springs between the bottom rows of each grid are than the rest.
+  @param[in] _baseStiffness The spring constant of the base as a multiple of the spring constant.
+  @param[in] _baseRows The number of rows at the bottom of each grid in the base.
+  */
+  void setBaseStiffness(float _baseStiffness, unsigned int _baseRows);
+
+  /**
+  @brief Sets the rest length of the structural springs, the shear and bend springs are kept in proportion.
+  @param[in] _restLength The rest length.
+  */
+  void setRestLength(float _restLength);
+
+  /**
+  @brief Gets the rest length of the structural springs.
+  @returns The rest length.
+  */
+  float getRestLength() const;
+
+  /**
+  @brief Sets the damping value of the springs.
+  @param[in] _damping The damping value.
+  */
+  void setDamping(float _damping);
+
+  /**
+  @brief Sets which springs the grids have on top of the structural springs.
+  @param[in] _shear True for the shear springs.
+  @param[in] _bend True for the bend springs.
+  */
+  void setSprings(bool _shear, bool _bend);
+
+  /**
+  @brief Computes the force of every spring and adds it to the force accumulators of the particles. Gives the same
+  result as a SpringStore holding the same springs.
+  @param[in,out] _particles The particles of the grids.
+  */
+  void computeForces(ParticleStore &_particles) const;
+
+  /**
+  @brief Computes the force on the particles of a range of rows, counting the rows of every grid one after the other.
+  @param[in,out] _particles The particles of the grids.
+  @param[in] _beginRow The index of the first row to compute.
+  @param[in] _endRow The index after the last row to compute.
+  */
+  void computeForces(ParticleStore &_particles, std::size_t _beginRow, std::size_t _endRow) const;
+
+  /**
+  @brief Computes the force of every spring, split across the TaskScheduler threads by row when there are enough
+  particles.
+  @param[in,out] _particles The particles of the grids.
+  */
+  void computeForcesParallel(ParticleStore &_particles) const;
+
+  /**
+  @brief Steps the particles through several symplectic Euler substeps a band of rows at a time. Each band is copied
+  with the rows around it that the substeps reach into a buffer small enough to stay in the cache, so the grids are
+  read from memory once for every few substeps instead of twice for each substep. The bands are split across the
+  TaskScheduler threads and give the same result as computing the forces and integrating for each substep in turn.
+  @param[in,out] _particles The particles of the grids.
+  @param[in] _externalForces The external force acting on the particles of each grid.
+  @param[in] _dt The delta time of a substep.
+  @param[in] _numSubsteps The number of substeps.
+  */
+  void stepBlocked(ParticleStore &_particles, const std::vector<glm::vec3> &_externalForces, float _dt,
+                   unsigned int _numSubsteps);
+
+  /**
+  @brief Sets the number of particles in each band stepped by stepBlocked, not counting the rows around it.
+  @param[in] _tileSize The number of particles, this is rounded down to whole rows.
+  */
+  void setTileSize(std::size_t _tileSize);
+
+  /**
+  @brief Sums the spring constants of the springs attached to each particle.
+  @param[out] _stiffness The sum for each particle.
+  */
+  void computeStiffnessSums(std::vector<float> &_stiffness) const;
+
+  /**
+  @brief Gets the rest length of the shortest spring.
+  @returns The shortest rest length.
+  */
+  float getMinRestLength() const;
+
+  ///The number of particles in a band by default, about 650KB of particle state so a band stays in the L2 cache.
+  static const std::size_t c_defaultTileSize = 16384;
+  ///The most substeps a band is stepped through at once, each one widens the rows copied around the band.
+  static const unsigned int c_maxBlockedSubsteps = 4;
+
+private:
+  ///The number of particles along each side of a grid.
+  unsigned int m_gridSize;
+  ///The number of grids.
+  std::size_t m_numGrids;
+  ///The spring constant of the springs.
+  float m_stiffness;
+  ///The spring constant of the base as a multiple of the spring constant.
+  float m_baseStiffness;
+  ///The number of rows at the bottom of each grid in the base.
+  unsigned int m_baseRows;
+  ///The rest length of the structural springs.
+  float m_restLength;
+  ///The damping value of the springs.
+  float m_damping;
+  ///A flag for if the grids have shear springs.
+  bool m_shear;
+  ///A flag for if the grids have bend springs.
+  bool m_bend;
+  ///The number of particles in each band stepped by stepBlocked.
+  std::size_t m_tileSize;
+  ///The positions and velocities the bands are stepped into, swapped with the particles once every band is done.
+  ParticleStore m_blockedState;
+
+  /**
+  @brief Computes the force on the particles of a range of rows held in a ParticleStore that starts part way through
+  the grids.
+  @param[in,out] _particles The particles of the rows.
+  @param[in] _firstRow The row of the first particle in the ParticleStore.
+  @param[in] _beginRow The first row to compute.
+  @param[in] _endRow The row after the last row to compute.
+  */
+  void computeRows(ParticleStore &_particles, std::size_t _firstRow, std::size_t _beginRow, std::size_t _endRow) const;
+
+  /**
+  @brief Steps one band of rows through the substeps and stores the result in the blocked state.
+  @param[in] _particles The particles of the grids at the start of the substeps.
+  @param[in] _externalForces The external force acting on the particles of each grid.
+  @param[in] _dt The delta time of a substep.
+  @param[in] _numSubsteps The number of substeps.
+  @param[in] _beginRow The first row of the band.
+  @param[in] _endRow The row after the last row of the band.
+  */
+  void stepBand(const ParticleStore &_particles, const std::vector<glm::vec3> &_externalForces, float _dt,
+                unsigned int _numSubsteps, std::size_t _beginRow, std::size_t _endRow);
+
+  /**
+  @brief Adds the force of the springs joining one row of a grid to the particles a fixed offset away.
+  @param[in,out] _particles The particles of the grids.
+  @param[in] _row The index of the first particle of the row.
+  @param[in] _y The row within its grid.
+  @param[in] _offsetX The offset to the other particles along the row.
+  @param[in] _offsetY The offset to the other particles along the column.
+  @param[in] _restLength The rest length of the springs.
+  */
+  void addNeighbours(ParticleStore &_particles, std::size_t _row, unsigned int _y, int _offsetX, int _offsetY,
+                     float _restLength) const;
+
+  /**
+  @brief Gets the spring constant of the springs between two rows of a grid.
+  @param[in] _y The first row.
+  @param[in] _otherY The second row.
+  @returns The spring constant.
+  */
+  float getStiffness(unsigned int _y, unsigned int _otherY) const;
+};
+
+#endif // GRIDSTENCIL_H_
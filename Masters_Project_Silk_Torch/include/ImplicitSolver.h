@@ -0,0 +1,134 @@
+#ifndef IMPLICITSOLVER_H_
+#define IMPLICITSOLVER_H_
+
+#include <vector>
+#include <cstddef>
+#include "glm/glm.hpp"
+
+#include "ParticleStore.h"
+#include "SpringStore.h"
+
+/// @file ImplicitSolver.h
+/// @brief A Class that integrates the particles of a mass spring object with backward Euler.
+/// The spring Jacobians are assembled each step and the change in velocity is solved with a Jacobi preconditioned
+/// conjugate gradient, warm started from the solution of the previous step. Unlike the explicit integration this stays
+/// stable with stiff springs and large time steps.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 22/08/19
+/// Revision History:
+/// Initial Version 22/08/19.
+class ImplicitSolver
+{
+public:
+  /**
+  @brief Constructs an ImplicitSolver with 50 maximum iterations and a tolerance of 1e-4f.
+  */
+  ImplicitSolver();
+
+  /**
+  @brief Destructs the ImplicitSolver.
+  */
+  ~ImplicitSolver();
+
+  /**
+  @brief Integrates the unlocked particles with backward Euler. The spring forces must already be in the force
+  accumulators of the particles.
+  @param[in] _springs The springs.
+  @param[in,out] _particles The particles the springs are attached to.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time.
+  */
+  void integrate(const SpringStore &_springs, ParticleStore &_particles, glm::vec3 _externalForce, float _dt);
+
+  /**
+  @brief Drops the warm start, this should be called when the particles are reset.
+  */
+  void reset();
+
+  /**
+  @brief Sets the maximum number of conjugate gradient iterations per step.
+  @param[in] _maxIterations The maximum number of iterations.
+  */
+  void setMaxIterations(unsigned int _maxIterations);
+
+  /**
+  @brief Gets the maximum number of conjugate gradient iterations per step.
+  @returns The maximum number of iterations.
+  */
+  unsigned int getMaxIterations() const;
+
+  /**
+  @brief Sets the tolerance of the conjugate gradient, relative to the size of the right hand side.
+  @param[in] _tolerance The tolerance.
+  */
+  void setTolerance(float _tolerance);
+
+  /**
+  @brief Gets the tolerance of the conjugate gradient.
+  @returns The tolerance.
+  */
+  float getTolerance() const;
+
+  /**
+  @brief Gets the number of conjugate gradient iterations used by the last step.
+  @returns The number of iterations.
+  */
+  unsigned int getLastIterations() const;
+
+private:
+  ///The force Jacobian of each spring with respect to the position of its point b.
+  std::vector<glm::mat3> m_jacobians;
+  ///The damping force Jacobian of each particle, the damping of every attached spring added together.
+  std::vector<float> m_dampingJacobian;
+  ///The inverse of the diagonal of the system, used as the preconditioner.
+  std::vector<glm::vec3> m_preconditioner;
+  ///The change in velocity, kept between steps for the warm start.
+  std::vector<glm::vec3> m_deltaVel;
+  ///The right hand side of the system.
+  std::vector<glm::vec3> m_rhs;
+  ///The residual of the conjugate gradient.
+  std::vector<glm::vec3> m_residual;
+  ///The preconditioned residual of the conjugate gradient.
+  std::vector<glm::vec3> m_preconditioned;
+  ///The search direction of the conjugate gradient.
+  std::vector<glm::vec3> m_direction;
+  ///The system multiplied by the search direction.
+  std::vector<glm::vec3> m_product;
+  ///The maximum number of conjugate gradient iterations per step.
+  unsigned int m_maxIterations;
+  ///The tolerance of the conjugate gradient.
+  float m_tolerance;
+  ///The number of conjugate gradient iterations used by the last step.
+  unsigned int m_lastIterations;
+
+  /**
+  @brief Assembles the spring and damping Jacobians and the preconditioner from the current state of the particles.
+  @param[in] _springs The springs.
+  @param[in] _particles The particles the springs are attached to.
+  @param[in] _dt The delta time.
+  */
+  void assemble(const SpringStore &_springs, const ParticleStore &_particles, float _dt);
+
+  /**
+  @brief Multiplies a vector by the stiffness matrix of the springs.
+  @param[in] _springs The springs.
+  @param[in] _x The vector to multiply, one value per particle.
+  @param[out] _result The result, one value per particle.
+  */
+  void multiplyStiffness(const SpringStore &_springs, const std::vector<glm::vec3> &_x, std::vector<glm::vec3> &_result) const;
+
+  /**
+  @brief Multiplies a vector by the backward Euler system, M - dt * dF/dv - dt^2 * dF/dx, with the locked particles
+  filtered out.
+  @param[in] _springs The springs.
+  @param[in] _particles The particles the springs are attached to.
+  @param[in] _dt The delta time.
+  @param[in] _x The vector to multiply, one value per particle.
+  @param[out] _result The result, one value per particle.
+  */
+  void multiplySystem(const SpringStore &_springs, const ParticleStore &_particles, float _dt, const std::vector<glm::vec3> &_x,
+                      std::vector<glm::vec3> &_result) const;
+};
+
+#endif // IMPLICITSOLVER_H_
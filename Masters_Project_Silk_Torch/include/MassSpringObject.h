@@ -7,8 +7,16 @@
 #include <ngl/VAOFactory.h>
 #include "glm/glm.hpp"
 
-#include "MassPoint.h"
-#include "Spring.h"
+#include "ParticleStore.h"
+#include "SpringStore.h"
+#include "ImplicitSolver.h"
+#include "ProjectiveSolver.h"
+#include "XpbdSolver.h"
+#include "Stepper.h"
+#include "AdaptiveStepController.h"
+#include "GridStencil.h"
+#include "MeshIndices.h"
+#include "GridOrdering.h"
 
 /// @file MassSpringObject.h
 /// @brief A Class that contains all the functions and members for the mass spring object.
@@ -17,6 +25,29 @@
 /// @date 03/08/19
 /// Revision History:
 /// Initial Version 03/08/19.
+
+/**
+@brief The solvers the particles of a mass spring object can be integrated with.
+*/
+enum class SolverType
+{
+  EXPLICIT,
+  IMPLICIT,
+  PROJECTIVE,
+  XPBD,
+  GRID_STENCIL
+};
+
+/**
+@brief The springs generated between the points of a mass spring object, each adds to the ones before it.
+*/
+enum class SpringTopology
+{
+  STRUCTURAL,
+  SHEAR,
+  SHEAR_AND_BEND
+};
+
 class MassSpringObject
 {
 public:
@@ -56,35 +87,37 @@ public:
   void setGridSize(unsigned int _gridSize);
 
   /**
-  @brief Gets a specific point in the grid.
-  @param[in] _pointIndex The index value of the wanted point.
-  @returns A shared pointer to the point.
+  @brief Gets the particles of the grid.
+  @returns A reference to the ParticleStore of the MassSpringObject, this is valid for the lifetime of the MassSpringObject.
   */
-  std::shared_ptr<MassPoint> getMassPoint(unsigned int _pointIndex);
+  const ParticleStore &getParticles() const;
 
   /**
-  @brief Gets the indices of the MassSpringObject.
-  @returns A std::vector of the Indices.
+  @brief Gets the indices of the MassSpringObject, these are 16 bit when the grid has up to 65536 points and 32 bit
+  when it has more.
+  @returns A reference to the indices, this is valid until the MassSpringObject is next generated.
   */
-  std::vector<GLshort> getIndices();
+  const MeshIndices &getIndices() const;
 
   /**
   @brief Gets the uv's of the MassSpringObject.
-  @returns A std::vector of the uv's.
+  @returns A reference to the std::vector of the uv's, this is valid until the MassSpringObject is next generated.
   */
-  std::vector<glm::vec2> getUVs();
+  const std::vector<glm::vec2> &getUVs() const;
 
   /**
   @brief Gets the vertices of the MassSpringObject.
-  @returns A std::vector of the Vertices.
+  @returns A reference to the std::vector of the vertices, this is valid until the MassSpringObject is next stepped or
+  generated.
   */
-  std::vector<glm::vec3> getVertices();
+  const std::vector<glm::vec3> &getVertices() const;
 
   /**
   @brief Gets the normals of the MassSpringObject.
-  @returns A std::vector of the normals.
+  @returns A reference to the std::vector of the normals, this is valid until the MassSpringObject is next stepped or
+  generated.
   */
-  std::vector<glm::vec3> getNormals();
+  const std::vector<glm::vec3> &getNormals() const;
 
   /**
   @brief Gets the position of the MassSpringObject.
@@ -116,6 +149,29 @@ public:
   */
   void update(float _dt);
 
+  /**
+  @brief Updates the wind impulse of the MassSpringObject and works out the external force acting on its points.
+  This is part of update and is also used when the MassSpringObject is stepped as part of a FlameBatch.
+  @param[in] _dt The delta time.
+  @returns The external force acting on every point for this step.
+  */
+  glm::vec3 updateExternalForces(float _dt);
+
+  /**
+  @brief Updates the vertices and transform of the MassSpringObject from its range in a shared ParticleStore.
+  This is used instead of update when the MassSpringObject is stepped as part of a FlameBatch.
+  @param[in] _particles The shared ParticleStore.
+  @param[in] _offset The index of the first point of the MassSpringObject in the shared ParticleStore.
+  */
+  void updateFromBatch(const ParticleStore &_particles, std::size_t _offset);
+
+  /**
+  @brief Copies the positions and velocities of the points back from a range in a shared ParticleStore.
+  @param[in] _particles The shared ParticleStore.
+  @param[in] _offset The index of the first point of the MassSpringObject in the shared ParticleStore.
+  */
+  void copyParticlesFrom(const ParticleStore &_particles, std::size_t _offset);
+
   /**
   @brief Resets the MassSpringObject.
   */
@@ -123,25 +179,32 @@ public:
 
   /**
   @brief Gets the Springs of the MassSpringObject.
-  @returns A std::vector of the Springs shared pointers.
+  @returns A reference to the SpringStore of the MassSpringObject, this is valid for the lifetime of the MassSpringObject.
+  The SpringStore is empty while the grid stencil solver is used.
   */
-  std::vector<std::shared_ptr<Spring>> getSprings();
+  const SpringStore &getSprings() const;
 
   /**
-  @brief A function to build the VAO data for the massSpringObject.
+  @brief Gets the GridStencil that finds the Springs of the MassSpringObject from the grid.
+  @returns A reference to the GridStencil of the MassSpringObject.
   */
-  void buildVAOData();
+  const GridStencil &getStencil() const;
 
   /**
-  @brief A function to rebuild the VAO data for the massSpringObject.
+  @brief Writes the positions of the points to draw straight into a buffer in the layout of the position buffer, three
+  floats each. The positions are a blend of the last two simulated states, this lets the flame be drawn between fixed
+  simulation steps. The uv's and indices do not change between steps so they are not written.
+  @param[in] _alpha The blend from the previous state at 0 to the current state at 1.
+  @param[out] _positions The buffer to write to, this must hold three floats for every vertex.
   */
-  void reBuildVAOData();
+  void packPositions(float _alpha, float *_positions) const;
 
   /**
-  @brief Gets the VAO data of the MassSpringObject.
-  @returns A std::vector of floats for the VAO.
+  @brief Gets the version of the indices and uv's, this changes whenever they are generated so a copy of them only
+  needs updating when it does.
+  @returns The version of the mesh, unique across every MassSpringObject.
   */
-  std::vector<float> getVAOData();
+  std::uint64_t getMeshVersion() const;
 
   /**
   @brief Sets the amount of time the wind impulse is on.
@@ -169,8 +232,8 @@ public:
   void setWindForce(char _axis, float _windForce);
 
   /**
-  @brief Sets the mass of the MassPoints.
-  @param[in] _mass The mass of the MassPoints.
+  @brief Sets the mass of the points.
+  @param[in] _mass The mass of the points.
   */
   void setMass(float _mass);
 
@@ -192,6 +255,78 @@ public:
   */
   void setRestLength(float _restLength);
 
+  /**
+  @brief Sets how much stiffer the springs at the base of the MassSpringObject are than the rest.
+  @param[in] _baseStiffness The spring constant of the base as a multiple of the spring constant.
+  */
+  void setBaseStiffness(float _baseStiffness);
+
+  /**
+  @brief Sets the springs generated between the points and generates them again. The shear springs join the diagonal
+  points and the bend springs join the points two apart, both cost about the same per spring as the structural springs
+  and let the MassSpringObject keep its shape with a lower spring constant.
+  @param[in] _topology The springs to generate.
+  */
+  void setTopology(SpringTopology _topology);
+
+  /**
+  @brief Gets the springs generated between the points.
+  @returns The topology of the springs.
+  */
+  SpringTopology getTopology() const;
+
+  /**
+  @brief Sets the order the particles of the grid are stored in and moves them into it. The tiled and Morton orders
+  keep the points above and below a point close in memory, which saves memory traffic on big grids. The grid stencil
+  solver walks whole rows so it always keeps the particles in row major order.
+  @param[in] _order The order of the particles.
+  */
+  void setParticleOrder(ParticleOrder _order);
+
+  /**
+  @brief Gets the order the particles of the grid are set to be stored in.
+  @returns The order of the particles.
+  */
+  ParticleOrder getParticleOrder() const;
+
+  /**
+  @brief Gets the mapping from the points of the grid to the particles.
+  @returns A reference to the GridOrdering of the MassSpringObject.
+  */
+  const GridOrdering &getOrdering() const;
+
+  /**
+  @brief Sets the solver the MassSpringObject is integrated with.
+  @param[in] _solverType The type of solver.
+  */
+  void setSolverType(SolverType _solverType);
+
+  /**
+  @brief Gets the solver the MassSpringObject is integrated with.
+  @returns The type of solver.
+  */
+  SolverType getSolverType() const;
+
+  /**
+  @brief Sets the integrator and precision of the explicit solver.
+  @param[in] _integratorType The integrator.
+  @param[in] _doublePrecision True to step in double precision, false for float.
+  */
+  void setIntegrator(IntegratorType _integratorType, bool _doublePrecision);
+
+  /**
+  @brief Sets if the grid stencil solver steps its substeps a band of the grid at a time while the band is in the
+  cache, rather than passing over the whole grid for every substep.
+  @param[in] _blockedSubsteps True to step the substeps in bands.
+  */
+  void setBlockedSubsteps(bool _blockedSubsteps);
+
+  /**
+  @brief Gets the number of substeps the explicit solver split the last step into.
+  @returns The number of substeps, 1 for the other solvers.
+  */
+  unsigned int getNumSubsteps() const;
+
   /**
   @brief Gets the transformation matrix of the MassSpringObject.
   @returns The transformation matrix.
@@ -210,19 +345,38 @@ public:
   */
   int getTextureNum();
 
+  ///The spring material of the structural springs, each kind of spring has its base material straight after it.
+  static const std::uint8_t c_structuralMaterial = 0;
+  ///The spring material of the shear springs.
+  static const std::uint8_t c_shearMaterial = 2;
+  ///The spring material of the bend springs.
+  static const std::uint8_t c_bendMaterial = 4;
+  ///The number of rows of points at the bottom of the grid that use the base material.
+  static const unsigned int c_baseRows = 2;
+
 private:
-  ///The array of pointers for the MassPoints.
-  std::vector<std::shared_ptr<MassPoint>> m_points;
-  ///The array of pointers for the Springs.
-  std::vector<std::shared_ptr<Spring>> m_springs;
+  ///The particles of the grid.
+  ParticleStore m_particles;
+  ///The edge list of the Springs.
+  SpringStore m_springs;
+  ///The stencil that finds the Springs from the grid, used in place of the edge list by the grid stencil solver.
+  GridStencil m_stencil;
   ///The size of the grid of points
   unsigned int m_gridSize;
+  ///The mapping from the points of the grid to the particles.
+  GridOrdering m_ordering;
+  ///The order the particles are set to be stored in.
+  ParticleOrder m_particleOrder;
   ///The indices of the MassSpringObject.
-  std::vector<GLshort> m_indices;
+  MeshIndices m_indices;
   ///The uv's of the MassSpringObject.
   std::vector<glm::vec2> m_uvs;
+  ///The version of the indices and uv's.
+  std::uint64_t m_meshVersion;
   ///The vertices of the MassSpringObject.
   std::vector<glm::vec3> m_vertices;
+  ///The vertices of the MassSpringObject before the last step, used to draw between steps.
+  std::vector<glm::vec3> m_previousVertices;
   ///The normals of the MassSpringObject.
   std::vector<glm::vec3> m_normals;
   ///The time since last wind impluse.
@@ -233,8 +387,6 @@ private:
   glm::vec3 m_pos;
   ///The scale of the MassSpringObject.
   glm::vec3 m_scale;
-  ///The std::vector of floats for the VAO.
-  std::vector<float> m_vaoData;
   ///The amount of time the wind impulse is on.
   float m_impulseOnTime;
   ///The amount of time the wind impulse is off.
@@ -243,12 +395,38 @@ private:
   float m_boyancy;
   ///The wind force.
   glm::vec3 m_windForce;
+  ///The mass of the particles.
+  float m_mass;
   ///The spring constant of the springs.
   float m_k;
   ///The damping of the MassSpringObject.
   float m_damp;
   ///The rest length of the springs.
   float m_restLength;
+  ///The spring constant of the base as a multiple of the spring constant.
+  float m_baseStiffness;
+  ///The springs generated between the points.
+  SpringTopology m_topology;
+  ///The solver the particles are integrated with.
+  SolverType m_solverType;
+  ///The implicit backward Euler solver.
+  ImplicitSolver m_implicitSolver;
+  ///The projective dynamics solver.
+  ProjectiveSolver m_projectiveSolver;
+  ///The position based dynamics solver.
+  XpbdSolver m_xpbdSolver;
+  ///The integrator of the explicit solver.
+  IntegratorType m_integratorType;
+  ///A flag for if the explicit solver steps in double precision.
+  bool m_doublePrecision;
+  ///A flag for if the grid stencil solver steps its substeps in bands.
+  bool m_blockedSubsteps;
+  ///The external force of the banded grid stencil step, kept so it is not allocated every update.
+  std::vector<glm::vec3> m_blockedExternalForces;
+  ///The explicit solver.
+  std::unique_ptr<AbstractStepper> m_stepper;
+  ///The controller that splits the explicit steps into substeps when they would be unstable.
+  AdaptiveStepController m_stepController;
   ///The transformation matrix of the MassSpringObject.
   glm::mat4 m_transform;
   ///The texture num.
@@ -281,15 +459,38 @@ private:
   void updateVertices();
 
   /**
-  @brief Generate the springs for the MassSpringObject.
+  @brief Keeps the current verticies of the MassSpringObject as the state before the next step.
+  */
+  void storePreviousVertices();
+
+  /**
+  @brief Keeps the current verticies of the MassSpringObject as the state before a step that writes every vertex
+  again, so they are swapped instead of copied.
+  */
+  void swapPreviousVertices();
+
+  /**
+  @brief Generate the springs for the MassSpringObject, the edge list is only built when the solver needs it.
   */
   void generateSprings();
 
+  /**
+  @brief Sets every spring material from the spring constant, base stiffness and rest length, the same way
+  generateSprings adds them.
+  */
+  void updateMaterials();
+
   /**
   @brief Generate the normals for the MassSpringObject.
   */
   void generateNormals();
 
+  /**
+  @brief Moves the particles into the order they should be stored in for the solver, generating the springs, indices
+  and uv's again when they move.
+  */
+  void applyParticleOrder();
+
   /**
   @brief Generate the transformation matrix for the MassSpringObject.
   */
@@ -0,0 +1,97 @@
+#ifndef MESHINDICES_H_
+#define MESHINDICES_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/// @file MeshIndices.h
+/// @brief A Class that contains the triangle indices of a mesh in the smallest index type that can address it.
+/// Meshes with up to 65536 vertices use 16 bit indices to halve the index memory, bigger meshes use 32 bit indices.
+/// The indices match GL_UNSIGNED_SHORT and GL_UNSIGNED_INT so they can be uploaded as they are.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 01/09/19
+/// Revision History:
+/// Initial Version 01/09/19.
+class MeshIndices
+{
+public:
+  /**
+  @brief Constructs an empty MeshIndices using 16 bit indices.
+  */
+  MeshIndices();
+
+  /**
+  @brief Destructs the MeshIndices.
+  */
+  ~MeshIndices();
+
+  /**
+  @brief Removes all of the indices and picks the index type for a mesh.
+  @param[in] _numVertices The number of vertices of the mesh.
+  */
+  void reset(std::size_t _numVertices);
+
+  /**
+  @brief Reserves the memory for a number of indices.
+  @param[in] _count The number of indices to reserve.
+  */
+  void reserve(std::size_t _count);
+
+  /**
+  @brief Adds an index to the end of the MeshIndices.
+  @param[in] _index The index of the vertex, this must be less than the number of vertices given to reset.
+  */
+  void add(std::size_t _index);
+
+  /**
+  @brief Gets the number of indices.
+  @returns The number of indices.
+  */
+  std::size_t size() const;
+
+  /**
+  @brief Gets if there are no indices.
+  @returns True if there are no indices.
+  */
+  bool empty() const;
+
+  /**
+  @brief Gets an index.
+  @param[in] _i The position of the index.
+  @returns The index of the vertex.
+  */
+  std::size_t get(std::size_t _i) const;
+
+  /**
+  @brief Gets if the indices are 32 bit.
+  @returns True for 32 bit indices, false for 16 bit indices.
+  */
+  bool getIsInt() const;
+
+  /**
+  @brief Gets the size of one index in bytes.
+  @returns The size of an index.
+  */
+  std::size_t getIndexSize() const;
+
+  /**
+  @brief Gets the indices to upload to OpenGL.
+  @returns A pointer to the first index, this is valid until the MeshIndices is changed.
+  */
+  const void *getData() const;
+
+  ///The most vertices a mesh can have and still use 16 bit indices.
+  static const std::size_t c_maxShortVertices = 65536;
+
+private:
+  ///The indices when the mesh uses 16 bit indices.
+  std::vector<std::uint16_t> m_shortIndices;
+  ///The indices when the mesh uses 32 bit indices.
+  std::vector<std::uint32_t> m_intIndices;
+  ///A flag for if the mesh uses 32 bit indices.
+  bool m_useInt;
+};
+
+#endif // MESHINDICES_H_
@@ -16,8 +16,10 @@
 #include "glm/glm.hpp"
 #include "Logging.h"
 #include "WindowParams.h"
-#include "MassSpringObject.h"
+#include "Simulation.h"
 #include "Timer.h"
+#include "FlameMesh.h"
+#include "FlameInstances.h"
 
 
 /// @file NGLScene.h
@@ -64,6 +66,12 @@ public:
     */
     void toggleTextured(bool _mode);
 
+    /**
+    @brief A slot to toggle drawing every flame with one instanced draw call.
+    @param[in] _mode The mode passed from the toggle button.
+    */
+    void toggleInstanced(bool _mode);
+
     /**
     @brief A slot to run the project.
     */
@@ -134,12 +142,72 @@ public:
     */
     void setRestLength(double _restLength);
 
+    /**
+    @brief A slot to set how much stiffer the Springs at the base of the MassSpringObjects are.
+    @param[in] _baseStiffness The multiple of the spring constant used at the base.
+    */
+    void setBaseStiffness(double _baseStiffness);
+
+    /**
+    @brief A slot to set the Springs generated between the points of the MassSpringObjects.
+    @param[in] _topology The index of the SpringTopology.
+    */
+    void setTopology(int _topology);
+
+    /**
+    @brief A slot to set the order the particles of the MassSpringObjects are stored in.
+    @param[in] _order The index of the ParticleOrder.
+    */
+    void setParticleOrder(int _order);
+
     /**
     @brief A slot to set the number of MassPointObjects.
     @param[in] _z The value of the number of MassPointObjects.
     */
     void setNumOfObject(int _numOfObjects);
 
+    /**
+    @brief A slot to set the number of points along each side of the MassSpringObjects.
+    @param[in] _gridSize The grid size.
+    */
+    void setGridSize(int _gridSize);
+
+    /**
+    @brief A slot to set the number of threads used to step the MassSpringObjects.
+    @param[in] _numThreads The number of threads, 0 uses one per core.
+    */
+    void setNumThreads(int _numThreads);
+
+    /**
+    @brief A slot to toggle if the MassSpringObjects are stepped together in one FlameBatch.
+    @param[in] _mode The mode passed from the toggle button.
+    */
+    void toggleBatched(bool _mode);
+
+    /**
+    @brief A slot to set the solver the MassSpringObjects are integrated with.
+    @param[in] _solverType The index of the SolverType.
+    */
+    void setSolverType(int _solverType);
+
+    /**
+    @brief A slot to set the integrator of the explicit solver.
+    @param[in] _integratorType The index of the IntegratorType.
+    */
+    void setIntegratorType(int _integratorType);
+
+    /**
+    @brief A slot to toggle if the explicit solver steps in double precision.
+    @param[in] _mode The mode passed from the toggle button.
+    */
+    void toggleDoublePrecision(bool _mode);
+
+    /**
+    @brief A slot to toggle if the grid stencil solver steps its substeps a band of rows at a time.
+    @param[in] _mode The mode passed from the toggle button.
+    */
+    void toggleBlockedSubsteps(bool _mode);
+
 protected:
   ///The model position.
   ngl::Vec3 m_modelPos;
@@ -165,16 +233,20 @@ private:
   int m_timerMilliseconds;
   ///The global mouse transformations.
   ngl::Mat4 m_mouseGlobalTX;
-  ///A unique pointer for the VAO.
-  std::unique_ptr<ngl::AbstractVAO> m_vao;
+  ///The buffers of each flame, kept between frames so only the positions are uploaded.
+  std::vector<std::unique_ptr<FlameMesh>> m_flameMeshes;
+  ///The buffers for drawing every flame at once.
+  std::unique_ptr<FlameInstances> m_flameInstances;
+  ///The texture array of the flame textures, the solid texture is the last layer.
+  GLuint m_textureArray;
+  ///A flag for if the flames are drawn with one instanced draw call.
+  bool m_instanced;
+  ///A flag for if the last frame was drawn instanced, the buffers of the other way are out of date when it changes.
+  bool m_drawnInstanced;
   ///Boolean for if the project is running
   bool m_projectRunning;
   ///The size of the massSpringObj grid
   unsigned int m_gridSize;
-  ///The mass spring object
-  std::vector<std::shared_ptr<MassSpringObject>> m_massSpringObjects;
-  ///The name of the texture
-  GLuint m_textureName[9];
   ///A flag for if the texture shader should be used.
   bool m_textured;
   ///The Timer for delta time.
@@ -191,10 +263,12 @@ private:
   bool initRun;
   ///Frame rate text
   std::unique_ptr<ngl::Text> m_frameRateText;
-  ///Number of mass spring objects
-  int m_numMassSpringObjects;
-  ///The scale of the mass spring objects
-  float m_MSOScale;
+  ///The simulation that steps the flames on its own thread.
+  Simulation m_simulation;
+  ///The integrator of the explicit solver.
+  IntegratorType m_integratorType;
+  ///A flag for if the explicit solver steps in double precision.
+  bool m_doublePrecision;
 
 protected:
   /**
@@ -239,23 +313,6 @@ private:
   */
   void wheelEvent(QWheelEvent* _event) override;
 
-  /**
-  @brief A funciton to set the data to be used by the VAO.
-  @param[in] _massSpringIndex The index of the mass spring.
-  */
-  void setVAOData(unsigned int _massSpringIndex);
-
-  /**
-  @brief A function to build the VAO.
-  */
-  void buildVAO();
-
-  /**
-  @brief A function to generate the mass spring objects.
-  @param[in] The number mass spring objects.
-  */
-  void generateMassSpringObjects(int _numOfObjects);
-
   /**
   @brief A function to initalise a shader.
   @param[in] _shader The shader to initalise.
@@ -265,6 +322,19 @@ private:
   */
   void initShader(ngl::ShaderLib* _shader, std::string _vertexShaderName, std::string _fragmentShaderName, std::string _shaderName);
 
+  /**
+  @brief A function to load the flame textures and the solid texture into the layers of the texture array.
+  */
+  void buildTextureArray();
+
+  /**
+  @brief A function to draw the flames one at a time with the buffers of each flame.
+  @param[in] _snapshot The snapshot of the flames.
+  @param[in] _uploadPositions True if the positions need uploading.
+  @param[in] _solidLayer The texture layer to draw every flame with, -1 to use the texture of each flame.
+  */
+  void drawFlames(const FrameSnapshot &_snapshot, bool _uploadPositions, int _solidLayer);
+
   /**
   @brief The frame timer for the simulation.
   @param _event The QT timer event.
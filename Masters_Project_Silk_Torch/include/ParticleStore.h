@@ -0,0 +1,235 @@
+#ifndef PARTICLESTORE_H_
+#define PARTICLESTORE_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "glm/glm.hpp"
+
+/// @file ParticleStore.h
+/// @brief A Class that contains the particles of a mass spring object as a structure of arrays.
+/// Each component of the particle state lives in its own contiguous array so the update passes stream through memory.
+/// @author Jamie Slowgrove
+/// @version 1.1
+/// @date 02/09/19
+/// Revision History:
+/// Initial Version 16/08/19.
+/// Modified Version 02/09/19 to move the particles into a new order and copy or swap the state of another
+/// ParticleStore.
+class ParticleStore
+{
+public:
+  /**
+  @brief Constructs an empty ParticleStore.
+  */
+  ParticleStore();
+
+  /**
+  @brief Destructs the ParticleStore.
+  */
+  ~ParticleStore();
+
+  /**
+  @brief Removes all of the particles from the ParticleStore.
+  */
+  void clear();
+
+  /**
+  @brief Reserves the memory for a number of particles.
+  @param[in] _count The number of particles to reserve.
+  */
+  void reserve(std::size_t _count);
+
+  /**
+  @brief Adds a particle to the ParticleStore. The particle starts at rest and unlocked.
+  @param[in] _pos The position of the particle.
+  @param[in] _mass The mass of the particle.
+  @returns The index of the new particle.
+  */
+  std::size_t addParticle(glm::vec3 _pos, float _mass);
+
+  /**
+  @brief Adds copies of all of the particles in another ParticleStore to the end of this one.
+  @param[in] _other The ParticleStore to copy the particles from.
+  */
+  void append(const ParticleStore &_other);
+
+  /**
+  @brief Copies the positions and velocities of a range of particles from another ParticleStore.
+  @param[in] _source The ParticleStore to copy from.
+  @param[in] _sourceBegin The index of the first particle to copy in the source.
+  @param[in] _count The number of particles to copy.
+  @param[in] _destBegin The index of the first particle to copy to in this ParticleStore.
+  */
+  void copyState(const ParticleStore &_source, std::size_t _sourceBegin, std::size_t _count, std::size_t _destBegin);
+
+  /**
+  @brief Moves the particles into a new order, keeping their whole state.
+  @param[in] _order The index each particle is moved from, one for every particle.
+  */
+  void reorder(const std::vector<std::uint32_t> &_order);
+
+  /**
+  @brief Replaces the particles with copies of a range of the particles in another ParticleStore, the copies start
+  with no force. This reuses the memory of the arrays once they are big enough.
+  @param[in] _source The ParticleStore to copy the particles from.
+  @param[in] _begin The index of the first particle to copy.
+  @param[in] _count The number of particles to copy.
+  */
+  void assign(const ParticleStore &_source, std::size_t _begin, std::size_t _count);
+
+  /**
+  @brief Swaps the positions and velocities of the particles with those of another ParticleStore of the same size.
+  @param[in,out] _other The ParticleStore to swap with.
+  */
+  void swapState(ParticleStore &_other);
+
+  /**
+  @brief Gets the number of particles in the ParticleStore.
+  @returns The number of particles.
+  */
+  std::size_t size() const;
+
+  /**
+  @brief Gets the position of a particle.
+  @param[in] _index The index of the particle.
+  @returns The position of the particle.
+  */
+  glm::vec3 getPos(std::size_t _index) const;
+
+  /**
+  @brief Sets the position of a particle.
+  @param[in] _index The index of the particle.
+  @param[in] _pos The new position.
+  */
+  void setPos(std::size_t _index, glm::vec3 _pos);
+
+  /**
+  @brief Gets the velocity of a particle.
+  @param[in] _index The index of the particle.
+  @returns The velocity of the particle.
+  */
+  glm::vec3 getVel(std::size_t _index) const;
+
+  /**
+  @brief Sets the velocity of a particle.
+  @param[in] _index The index of the particle.
+  @param[in] _vel The new velocity.
+  */
+  void setVel(std::size_t _index, glm::vec3 _vel);
+
+  /**
+  @brief Gets the accumulated internal force of a particle.
+  @param[in] _index The index of the particle.
+  @returns The accumulated force of the particle.
+  */
+  glm::vec3 getForce(std::size_t _index) const;
+
+  /**
+  @brief Adds a force to the accumulated internal force of a particle.
+  @param[in] _index The index of the particle.
+  @param[in] _force The force to add.
+  */
+  void addForce(std::size_t _index, glm::vec3 _force);
+
+  /**
+  @brief Resets the accumulated internal forces of all of the particles.
+  */
+  void clearForces();
+
+  /**
+  @brief Gets the mass of a particle.
+  @param[in] _index The index of the particle.
+  @returns The mass of the particle.
+  */
+  float getMass(std::size_t _index) const;
+
+  /**
+  @brief Sets the mass of every particle.
+  @param[in] _mass The new mass.
+  */
+  void setMass(float _mass);
+
+  /**
+  @brief Sets the locked state of a particle to true.
+  @param[in] _index The index of the particle.
+  */
+  void lock(std::size_t _index);
+
+  /**
+  @brief Sets the locked state of a particle to false.
+  @param[in] _index The index of the particle.
+  */
+  void unlock(std::size_t _index);
+
+  /**
+  @brief Gets the locked state of a particle.
+  @param[in] _index The index of the particle.
+  @returns The locked state of the particle.
+  */
+  bool getIsLocked(std::size_t _index) const;
+
+  /**
+  @brief Integrates the unlocked particles using the accumulated internal forces and a shared external force.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time.
+  */
+  void integrate(glm::vec3 _externalForce, float _dt);
+
+  /**
+  @brief Integrates a range of the unlocked particles using the accumulated internal forces and a shared external force.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time.
+  @param[in] _begin The index of the first particle to integrate.
+  @param[in] _end The index after the last particle to integrate.
+  */
+  void integrate(glm::vec3 _externalForce, float _dt, std::size_t _begin, std::size_t _end);
+
+  ///Raw access to the particle arrays for the solver kernels.
+  float *getPosX() { return m_posX.data(); }
+  float *getPosY() { return m_posY.data(); }
+  float *getPosZ() { return m_posZ.data(); }
+  float *getVelX() { return m_velX.data(); }
+  float *getVelY() { return m_velY.data(); }
+  float *getVelZ() { return m_velZ.data(); }
+  float *getForceX() { return m_forceX.data(); }
+  float *getForceY() { return m_forceY.data(); }
+  float *getForceZ() { return m_forceZ.data(); }
+  const float *getPosX() const { return m_posX.data(); }
+  const float *getPosY() const { return m_posY.data(); }
+  const float *getPosZ() const { return m_posZ.data(); }
+  const float *getVelX() const { return m_velX.data(); }
+  const float *getVelY() const { return m_velY.data(); }
+  const float *getVelZ() const { return m_velZ.data(); }
+  const float *getForceX() const { return m_forceX.data(); }
+  const float *getForceY() const { return m_forceY.data(); }
+  const float *getForceZ() const { return m_forceZ.data(); }
+  const float *getInvMass() const { return m_invMass.data(); }
+  const std::uint8_t *getLocked() const { return m_locked.data(); }
+
+private:
+  ///The x components of the particle positions.
+  std::vector<float> m_posX;
+  ///The y components of the particle positions.
+  std::vector<float> m_posY;
+  ///The z components of the particle positions.
+  std::vector<float> m_posZ;
+  ///The x components of the particle velocities.
+  std::vector<float> m_velX;
+  ///The y components of the particle velocities.
+  std::vector<float> m_velY;
+  ///The z components of the particle velocities.
+  std::vector<float> m_velZ;
+  ///The x components of the accumulated internal forces.
+  std::vector<float> m_forceX;
+  ///The y components of the accumulated internal forces.
+  std::vector<float> m_forceY;
+  ///The z components of the accumulated internal forces.
+  std::vector<float> m_forceZ;
+  ///The inverse masses of the particles.
+  std::vector<float> m_invMass;
+  ///The locked flags of the particles, 1 if locked in place.
+  std::vector<std::uint8_t> m_locked;
+};
+
+#endif // PARTICLESTORE_H_
@@ -0,0 +1,125 @@
+#ifndef PROJECTIVESOLVER_H_
+#define PROJECTIVESOLVER_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "glm/glm.hpp"
+
+#include "ParticleStore.h"
+#include "SpringStore.h"
+#include "BandedCholesky.h"
+
+/// @file ProjectiveSolver.h
+/// @brief A Class that integrates the particles of a mass spring object with projective dynamics.
+/// Each iteration projects every spring to its rest length in parallel, then solves one global system for the
+/// positions. The global matrix only depends on the masses, the spring constants and the grid so it is Cholesky
+/// factored once, after a reverse Cuthill-McKee ordering to keep its band narrow, and each iteration is a pair of
+/// triangular solves.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 23/08/19
+/// Revision History:
+/// Initial Version 23/08/19.
+class ProjectiveSolver
+{
+public:
+  /**
+  @brief Constructs a ProjectiveSolver with 10 iterations per step.
+  */
+  ProjectiveSolver();
+
+  /**
+  @brief Destructs the ProjectiveSolver.
+  */
+  ~ProjectiveSolver();
+
+  /**
+  @brief Integrates the unlocked particles with projective dynamics. The force accumulators of the particles are
+  added to the external force, they must not hold the spring forces.
+  @param[in] _springs The springs.
+  @param[in,out] _particles The particles the springs are attached to.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time.
+  */
+  void integrate(const SpringStore &_springs, ParticleStore &_particles, glm::vec3 _externalForce, float _dt);
+
+  /**
+  @brief Marks the factorisation as out of date, this should be called when the masses, spring constants or grid change.
+  */
+  void invalidate();
+
+  /**
+  @brief Sets the number of local and global iterations per step.
+  @param[in] _iterations The number of iterations.
+  */
+  void setIterations(unsigned int _iterations);
+
+  /**
+  @brief Gets the number of local and global iterations per step.
+  @returns The number of iterations.
+  */
+  unsigned int getIterations() const;
+
+  /**
+  @brief Gets the number of times the global matrix has been factored.
+  @returns The number of factorisations.
+  */
+  unsigned int getNumFactorisations() const;
+
+  /**
+  @brief Gets the bandwidth of the factored global matrix.
+  @returns The bandwidth.
+  */
+  std::size_t getBandwidth() const;
+
+private:
+  ///The Cholesky factor of the global matrix, shared by the x, y and z solves.
+  BandedCholesky m_factor;
+  ///A flag for if the factor matches the current masses, spring constants and grid.
+  bool m_factorised;
+  ///The delta time the factor was built for.
+  float m_factorDt;
+  ///The number of particles the factor was built for.
+  std::size_t m_factorParticles;
+  ///The number of springs the factor was built for.
+  std::size_t m_factorSprings;
+  ///The row of each particle in the global matrix, -1 for locked particles.
+  std::vector<std::int64_t> m_rows;
+  ///The particle of each row in the global matrix.
+  std::vector<std::size_t> m_rowParticles;
+  ///The number of springs attached to each particle, for the damping.
+  std::vector<float> m_numAttached;
+  ///The inertia of each particle, the mass over the factored delta time squared.
+  std::vector<double> m_inertia;
+  ///The inertial target position of each particle.
+  std::vector<glm::vec3> m_targets;
+  ///The current solution for the position of each particle.
+  std::vector<glm::vec3> m_positions;
+  ///The projected vector from point a to point b of each spring.
+  std::vector<glm::vec3> m_projections;
+  ///The right hand sides of the global solve, one per axis.
+  std::vector<double> m_rhs[3];
+  ///The number of local and global iterations per step.
+  unsigned int m_iterations;
+  ///The number of times the global matrix has been factored.
+  unsigned int m_numFactorisations;
+
+  /**
+  @brief Orders the free particles with reverse Cuthill-McKee, assembles the global matrix and factors it.
+  @param[in] _springs The springs.
+  @param[in] _particles The particles the springs are attached to.
+  @param[in] _dt The delta time.
+  */
+  void factorise(const SpringStore &_springs, const ParticleStore &_particles, float _dt);
+
+  /**
+  @brief Projects each spring in a range to its rest length.
+  @param[in] _springs The springs.
+  @param[in] _begin The index of the first spring to project.
+  @param[in] _end The index after the last spring to project.
+  */
+  void project(const SpringStore &_springs, std::size_t _begin, std::size_t _end);
+};
+
+#endif // PROJECTIVESOLVER_H_
@@ -0,0 +1,104 @@
+#ifndef SIMDKERNELS_H_
+#define SIMDKERNELS_H_
+
+#include <string>
+#include <cstddef>
+#include "glm/glm.hpp"
+
+#include "ParticleStore.h"
+#include "SpringStore.h"
+
+/// @file SimdKernels.h
+/// @brief A namespace that contains the vectorised spring force and integration kernels.
+/// The SSE2, AVX2 and AVX-512 versions are all compiled into the same binary and the best one the CPU supports is
+/// picked the first time a kernel is used, hosts without any of them fall back to the scalar SpringStore and
+/// ParticleStore functions.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 18/08/19
+/// Revision History:
+/// Initial Version 18/08/19.
+namespace SimdKernels
+{
+  /**
+  @brief The instruction sets the kernels are written for, in order of preference.
+  */
+  enum class Isa
+  {
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512
+  };
+
+  /**
+  @brief Gets the best instruction set supported by the CPU and OS.
+  @returns The detected instruction set.
+  */
+  Isa getDetectedIsa();
+
+  /**
+  @brief Gets the instruction set used by the kernels.
+  @returns The instruction set in use.
+  */
+  Isa getIsa();
+
+  /**
+  @brief Sets the instruction set used by the kernels, this is clamped to the detected instruction set.
+  This is for testing and benchmarking and should not be called while a kernel is running.
+  @param[in] _isa The wanted instruction set.
+  */
+  void setIsa(Isa _isa);
+
+  /**
+  @brief Converts an instruction set to a string.
+  @param[in] _isa The instruction set.
+  @returns The name of the instruction set.
+  */
+  std::string isaToString(Isa _isa);
+
+  /**
+  @brief Computes the force of a range of springs and adds it to the force accumulators of the attached particles.
+  Gives the same result as SpringStore::computeForces.
+  @param[in] _springs The springs.
+  @param[in,out] _particles The particles the springs are attached to.
+  @param[in] _begin The index of the first spring to compute.
+  @param[in] _end The index after the last spring to compute.
+  */
+  void computeSpringForces(const SpringStore &_springs, ParticleStore &_particles, std::size_t _begin, std::size_t _end);
+
+  /**
+  @brief Integrates a range of the unlocked particles. Gives the same result as ParticleStore::integrate.
+  @param[in,out] _particles The particles.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time.
+  @param[in] _begin The index of the first particle to integrate.
+  @param[in] _end The index after the last particle to integrate.
+  */
+  void integrate(ParticleStore &_particles, glm::vec3 _externalForce, float _dt, std::size_t _begin, std::size_t _end);
+
+  /**
+  @brief Computes the force of every spring. When there are enough springs each colour batch is split across the
+  TaskScheduler threads, no two springs in a batch share a particle so this needs no atomics.
+  @param[in] _springs The springs.
+  @param[in,out] _particles The particles the springs are attached to.
+  */
+  void computeSpringForcesParallel(const SpringStore &_springs, ParticleStore &_particles);
+
+  /**
+  @brief Integrates a range of the unlocked particles, split across the TaskScheduler threads when the range is big enough.
+  @param[in,out] _particles The particles.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time.
+  @param[in] _begin The index of the first particle to integrate.
+  @param[in] _end The index after the last particle to integrate.
+  */
+  void integrateParallel(ParticleStore &_particles, glm::vec3 _externalForce, float _dt, std::size_t _begin, std::size_t _end);
+
+  ///The number of springs or points a pass needs before it is split across the threads.
+  const std::size_t c_parallelThreshold = 8192;
+  ///The number of springs or points given to a thread at a time.
+  const std::size_t c_parallelGrainSize = 2048;
+}
+
+#endif // SIMDKERNELS_H_
@@ -0,0 +1,348 @@
+#ifndef SIMULATION_H_
+#define SIMULATION_H_
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include "glm/glm.hpp"
+
+#include "MassSpringObject.h"
+#include "FlameBatch.h"
+#include "FixedStepClock.h"
+#include "Timer.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+
+/// @file Simulation.h
+/// @brief A Class that owns the flames and steps them on a thread of its own.
+/// After each pass the vertices of every flame are copied into a FrameSnapshot and published through a TripleBuffer,
+/// the drawing thread takes the newest snapshot without waiting and never touches the flames. The settings are queued
+/// as commands on a SpscQueue and every command queued before a pass is applied at the start of it, so a change never
+/// lands part way through a step. The settings, start and stop must all be called from the same thread.
+/// @author Jamie Slowgrove
+/// @version 1.1
+/// @date 29/08/19
+/// Revision History:
+/// Initial Version 28/08/19.
+/// Modified Version 29/08/19 to queue the settings as commands instead of locking the flames.
+
+/**
+@brief The state of a flame needed to draw it.
+*/
+struct FlameSnapshot
+{
+  ///The positions of the points, three floats each.
+  std::vector<float> m_positions;
+  ///The uv's of the points.
+  std::vector<glm::vec2> m_uvs;
+  ///The indices of the triangles.
+  MeshIndices m_indices;
+  ///The version of the uv's and indices, these are only copied when it changes.
+  std::uint64_t m_meshVersion = 0;
+  ///The transformation matrix.
+  glm::mat4 m_transform;
+  ///The number of the texture.
+  int m_textureNum = 0;
+};
+
+/**
+@brief The state of every flame at the end of a simulation pass.
+*/
+struct FrameSnapshot
+{
+  ///The flames.
+  std::vector<FlameSnapshot> m_flames;
+  ///The most substeps any flame took in its last step.
+  unsigned int m_numSubsteps = 1;
+};
+
+/**
+@brief The settings that can be sent to the simulation thread.
+*/
+enum class SimulationCommandType
+{
+  GENERATE_FLAMES,
+  GRID_SIZE,
+  RESTART,
+  BUOYANCY,
+  WIND_IMPULSE_ON,
+  WIND_IMPULSE_OFF,
+  WIND_FORCE,
+  MASS,
+  SPRING_CONSTANT,
+  DAMPING,
+  REST_LENGTH,
+  BASE_STIFFNESS,
+  TOPOLOGY,
+  PARTICLE_ORDER,
+  NUM_THREADS,
+  BATCHED,
+  SOLVER_TYPE,
+  INTEGRATOR,
+  BLOCKED_SUBSTEPS
+};
+
+/**
+@brief A change of a setting queued for the simulation thread.
+*/
+struct SimulationCommand
+{
+  ///The setting to change.
+  SimulationCommandType m_type;
+  ///The value of the float settings.
+  float m_value;
+  ///The value of the whole number and enum settings.
+  int m_intValue;
+  ///The axis of the wind force.
+  char m_axis;
+  ///The value of the on or off settings.
+  bool m_flag;
+};
+
+class Simulation
+{
+public:
+  /**
+  @brief Constructs a Simulation with one flame that is not running.
+  @param[in] _gridSize The size of the grid of points of each flame.
+  */
+  Simulation(unsigned int _gridSize);
+
+  /**
+  @brief Stops the simulation thread and destructs the Simulation.
+  */
+  ~Simulation();
+
+  /**
+  @brief Starts the simulation thread, this does nothing if it is already running.
+  */
+  void start();
+
+  /**
+  @brief Stops the simulation thread and waits for its pass to finish.
+  */
+  void stop();
+
+  /**
+  @brief Gets if the simulation thread is running.
+  @returns True if the thread is running.
+  */
+  bool isRunning() const;
+
+  /**
+  @brief Runs one pass of the simulation, applying the queued commands, taking the fixed steps a frame time covers
+  and publishing a snapshot. This is what the simulation thread runs, it can be called directly when the thread is
+  not running.
+  @param[in] _frameTime The time since the last pass in seconds.
+  */
+  void step(float _frameTime);
+
+  /**
+  @brief Takes the newest published snapshot if there is one, only the drawing thread may call this.
+  @returns True if a new snapshot was taken.
+  */
+  bool updateSnapshot();
+
+  /**
+  @brief Gets the snapshot taken by the last updateSnapshot, only the drawing thread may call this.
+  @returns A reference to the snapshot, this is valid until the next updateSnapshot.
+  */
+  const FrameSnapshot &getSnapshot() const;
+
+  /**
+  @brief Replaces the flames with a square grid of new flames.
+  @param[in] _numOfObjects The number of flames along each side minus one.
+  */
+  void generateFlames(int _numOfObjects);
+
+  /**
+  @brief Replaces the flames with flames of a new grid size. The flames are scaled to take up the same space whatever
+  their grid size.
+  @param[in] _gridSize The number of points along each side of a flame.
+  */
+  void setGridSize(unsigned int _gridSize);
+
+  /**
+  @brief Resets every flame to its starting state.
+  */
+  void restart();
+
+  /**
+  @brief Sets the buoyancy of every flame.
+  @param[in] _buoyancy The buoyancy.
+  */
+  void setBuoyancy(float _buoyancy);
+
+  /**
+  @brief Sets the amount of time the wind impulse of every flame is on.
+  @param[in] _impulseOnTime The amount of time the wind impulse is on.
+  */
+  void setWindImpulseOn(float _impulseOnTime);
+
+  /**
+  @brief Sets the amount of time the wind impulse of every flame is off.
+  @param[in] _impulseOffTime The amount of time the wind impulse is off.
+  */
+  void setWindImpulseOff(float _impulseOffTime);
+
+  /**
+  @brief Sets one axis of the wind force of every flame.
+  @param[in] _axis The axis to set, x, y or z.
+  @param[in] _windForce The wind force on the axis.
+  */
+  void setWindForce(char _axis, float _windForce);
+
+  /**
+  @brief Sets the mass of the points of every flame.
+  @param[in] _mass The mass of the points.
+  */
+  void setMass(float _mass);
+
+  /**
+  @brief Sets the constant of the springs of every flame.
+  @param[in] _springConstant The spring constant.
+  */
+  void setSpringConstant(float _springConstant);
+
+  /**
+  @brief Sets the damping of the springs of every flame.
+  @param[in] _damping The damping value.
+  */
+  void setDamping(float _damping);
+
+  /**
+  @brief Sets the rest length of the springs of every flame.
+  @param[in] _restLength The spring rest length.
+  */
+  void setRestLength(float _restLength);
+
+  /**
+  @brief Sets how much stiffer the springs at the base of every flame are than the rest.
+  @param[in] _baseStiffness The spring constant of the base as a multiple of the spring constant.
+  */
+  void setBaseStiffness(float _baseStiffness);
+
+  /**
+  @brief Sets the springs generated between the points of every flame.
+  @param[in] _topology The topology of the springs.
+  */
+  void setTopology(SpringTopology _topology);
+
+  /**
+  @brief Sets the order the particles of every flame are stored in.
+  @param[in] _order The order of the particles.
+  */
+  void setParticleOrder(ParticleOrder _order);
+
+  /**
+  @brief Sets the number of threads the solver kernels are split across.
+  @param[in] _numThreads The number of threads.
+  */
+  void setNumThreads(unsigned int _numThreads);
+
+  /**
+  @brief Sets if the flames are stepped together in one FlameBatch.
+  @param[in] _batched True to step the flames in the batch.
+  */
+  void setBatched(bool _batched);
+
+  /**
+  @brief Sets the solver every flame is integrated with.
+  @param[in] _solverType The type of solver.
+  */
+  void setSolverType(SolverType _solverType);
+
+  /**
+  @brief Sets the integrator and precision of the explicit solver of every flame.
+  @param[in] _integratorType The integrator.
+  @param[in] _doublePrecision True to step in double precision, false for float.
+  */
+  void setIntegrator(IntegratorType _integratorType, bool _doublePrecision);
+
+  /**
+  @brief Sets if the grid stencil solver steps the substeps of every flame a band of rows at a time.
+  @param[in] _blockedSubsteps True to step the substeps in bands.
+  */
+  void setBlockedSubsteps(bool _blockedSubsteps);
+
+  ///The grid size the camera is set up for, bigger grids are scaled down to fit it.
+  static const unsigned int c_viewGridSize = 10;
+
+private:
+  ///The flames.
+  std::vector<std::shared_ptr<MassSpringObject>> m_massSpringObjects;
+  ///The batch that steps all of the flames together.
+  FlameBatch m_flameBatch;
+  ///The size of the grid of points of each flame.
+  unsigned int m_gridSize;
+  ///The number of flames along each side minus one.
+  int m_numOfObjects;
+  ///A flag for if the flames are stepped in the batch.
+  bool m_batched;
+  ///A flag for if the batch needs rebuilding before the next step.
+  bool m_batchDirty;
+  ///The solver the flames are integrated with.
+  SolverType m_solverType;
+  ///The integrator of the explicit solver.
+  IntegratorType m_integratorType;
+  ///A flag for if the explicit solver steps in double precision.
+  bool m_doublePrecision;
+  ///A flag for if the grid stencil solver steps its substeps in bands.
+  bool m_blockedSubsteps;
+  ///The springs generated between the points of every flame.
+  SpringTopology m_topology;
+  ///The order the particles of every flame are stored in.
+  ParticleOrder m_particleOrder;
+  ///How much stiffer the springs at the base of every flame are than the rest.
+  float m_baseStiffness;
+  ///The clock that splits the frame time into fixed simulation steps.
+  FixedStepClock m_stepClock;
+  ///The most substeps any flame took in its last step.
+  unsigned int m_numSubsteps;
+  ///The snapshots passed to the drawing thread.
+  TripleBuffer<FrameSnapshot> m_snapshots;
+  ///The settings queued for the next pass.
+  SpscQueue<SimulationCommand> m_commands;
+  ///The simulation thread.
+  std::thread m_thread;
+  ///A flag for if the simulation thread should keep running.
+  std::atomic<bool> m_running;
+
+  /**
+  @brief The loop of the simulation thread.
+  */
+  void run();
+
+  /**
+  @brief Queues a command for the next pass. When the simulation thread is not running the command is applied
+  straight away.
+  @param[in] _command The command.
+  */
+  void pushCommand(const SimulationCommand &_command);
+
+  /**
+  @brief Applies every queued command, only the thread stepping the flames may call this.
+  */
+  void applyCommands();
+
+  /**
+  @brief Applies a command to the flames.
+  @param[in] _command The command.
+  */
+  void applyCommand(const SimulationCommand &_command);
+
+  /**
+  @brief Replaces the flames with a square grid of new flames and publishes them.
+  @param[in] _numOfObjects The number of flames along each side minus one.
+  */
+  void buildFlames(int _numOfObjects);
+
+  /**
+  @brief Writes the positions of every flame straight into the back snapshot and publishes it.
+  @param[in] _alpha The blend from the previous state of the flames at 0 to the current state at 1.
+  */
+  void publishSnapshot(float _alpha);
+};
+
+#endif // SIMULATION_H_
@@ -0,0 +1,294 @@
+#ifndef SPRINGSTORE_H_
+#define SPRINGSTORE_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "ParticleStore.h"
+
+/// @file SpringStore.h
+/// @brief A Class that contains the springs of a mass spring object as a flat edge list.
+/// Each spring is a pair of particle indices and the index of its material, there are no per spring objects. The
+/// stiffness and rest length live in a small material table shared by the springs, so changing them is one write to
+/// the table whatever the number of springs and the table stays in cache while the kernels read it. A region of
+/// springs can be given its own material to override the rest, for example a stiffer base.
+/// @author Jamie Slowgrove
+/// @version 1.2
+/// @date 05/09/19
+/// Revision History:
+/// Initial Version 17/08/19.
+/// Modified Version 30/08/19 to share the stiffness and rest length through a material table.
+/// Modified Version 05/09/19 to keep the ratio of each material to the first so it survives a value of zero.
+class SpringStore
+{
+public:
+  /**
+  @brief Constructs an empty SpringStore with a damping value of 0.1f.
+  */
+  SpringStore();
+
+  /**
+  @brief Destructs the SpringStore.
+  */
+  ~SpringStore();
+
+  /**
+  @brief Removes all of the springs and materials from the SpringStore.
+  */
+  void clear();
+
+  /**
+  @brief Reserves the memory for a number of springs.
+  @param[in] _count The number of springs to reserve.
+  */
+  void reserve(std::size_t _count);
+
+  /**
+  @brief Adds a material to the table. There can be at most c_maxMaterials materials, past that the last material is
+  returned and an error is logged.
+  @param[in] _stiffness The spring constant of the material.
+  @param[in] _restLength The rest length of the material.
+  @returns The index of the new material.
+  */
+  std::uint8_t addMaterial(float _stiffness, float _restLength);
+
+  /**
+  @brief Gets the number of materials in the table.
+  @returns The number of materials.
+  */
+  std::size_t getNumMaterials() const;
+
+  /**
+  @brief Gets the spring constant of a material.
+  @param[in] _material The index of the material.
+  @returns The spring constant.
+  */
+  float getMaterialStiffness(std::uint8_t _material) const;
+
+  /**
+  @brief Sets the spring constant of a material, this changes every spring using it.
+  @param[in] _material The index of the material.
+  @param[in] _stiffness The new spring constant.
+  */
+  void setMaterialStiffness(std::uint8_t _material, float _stiffness);
+
+  /**
+  @brief Gets the rest length of a material.
+  @param[in] _material The index of the material.
+  @returns The rest length.
+  */
+  float getMaterialRestLength(std::uint8_t _material) const;
+
+  /**
+  @brief Sets the rest length of a material, this changes every spring using it.
+  @param[in] _material The index of the material.
+  @param[in] _restLength The new rest length.
+  */
+  void setMaterialRestLength(std::uint8_t _material, float _restLength);
+
+  /**
+  @brief Adds a spring to the SpringStore.
+  @param[in] _pointA The particle index of the point A of the spring.
+  @param[in] _pointB The particle index of the point B of the spring.
+  @param[in] _material The index of the material of the spring.
+  @returns The index of the new spring.
+  */
+  std::size_t addSpring(std::uint32_t _pointA, std::uint32_t _pointB, std::uint8_t _material);
+
+  /**
+  @brief Adds a spring to the SpringStore using the material with the same values, the material is added if there is
+  not one already.
+  @param[in] _pointA The particle index of the point A of the spring.
+  @param[in] _pointB The particle index of the point B of the spring.
+  @param[in] _stiffness The spring constant of the spring.
+  @param[in] _restLength The rest length of the spring.
+  @returns The index of the new spring.
+  */
+  std::size_t addSpring(std::uint32_t _pointA, std::uint32_t _pointB, float _stiffness, float _restLength);
+
+  /**
+  @brief Adds copies of all of the springs in another SpringStore to the end of this one. The materials of the other
+  SpringStore are matched to the materials here with the same values, so copies of the same flame share them and keep
+  the same material indices.
+  @param[in] _other The SpringStore to copy the springs from.
+  @param[in] _pointOffset The offset added to the particle indices of the copied springs.
+  */
+  void append(const SpringStore &_other, std::uint32_t _pointOffset);
+
+  /**
+  @brief Gets the number of springs in the SpringStore.
+  @returns The number of springs.
+  */
+  std::size_t size() const;
+
+  /**
+  @brief Gets the point A of a spring.
+  @param[in] _index The index of the spring.
+  @returns The particle index of the point A.
+  */
+  std::uint32_t getPointA(std::size_t _index) const;
+
+  /**
+  @brief Gets the point B of a spring.
+  @param[in] _index The index of the spring.
+  @returns The particle index of the point B.
+  */
+  std::uint32_t getPointB(std::size_t _index) const;
+
+  /**
+  @brief Gets the material of a spring.
+  @param[in] _index The index of the spring.
+  @returns The index of the material.
+  */
+  std::uint8_t getMaterial(std::size_t _index) const;
+
+  /**
+  @brief Sets the material of a spring.
+  @param[in] _index The index of the spring.
+  @param[in] _material The index of the material.
+  */
+  void setMaterial(std::size_t _index, std::uint8_t _material);
+
+  /**
+  @brief Gets the spring constant of a spring from its material.
+  @param[in] _index The index of the spring.
+  @returns The spring constant of the spring.
+  */
+  float getStiffness(std::size_t _index) const;
+
+  /**
+  @brief Sets the spring constant of the first material and sets the other materials from their ratio to it, so the
+  overrides keep their ratio even after passing through zero.
+  @param[in] _stiffness The new spring constant.
+  */
+  void setStiffness(float _stiffness);
+
+  /**
+  @brief Gets the rest length of a spring from its material.
+  @param[in] _index The index of the spring.
+  @returns The rest length of the spring.
+  */
+  float getRestLength(std::size_t _index) const;
+
+  /**
+  @brief Sets the rest length of the first material and sets the other materials from their ratio to it, so the
+  overrides keep their ratio even after passing through zero.
+  @param[in] _restLength The new rest length.
+  */
+  void setRestLength(float _restLength);
+
+  /**
+  @brief Gets the damping value of the springs.
+  @returns The damping value.
+  */
+  float getDamping() const;
+
+  /**
+  @brief Sets the damping value of the springs.
+  @param[in] _damping The new damping value.
+  */
+  void setDamping(float _damping);
+
+  /**
+  @brief Sorts the springs into colour batches where no two springs in a batch share a particle, so the springs of
+  one batch can be computed in parallel without any atomics. The colours are picked greedily, a regular grid of
+  horizontal and vertical springs needs four. Adding a spring clears the batches. There are at most 64 colours, if a
+  spring has none left the error is logged and the springs are left uncoloured so they are computed serially.
+  */
+  void buildColourBatches();
+
+  /**
+  @brief Gets the number of colour batches.
+  @returns The number of colour batches, 0 if the springs have not been coloured.
+  */
+  std::size_t getNumColours() const;
+
+  /**
+  @brief Gets the index of the first spring in a colour batch.
+  @param[in] _colour The colour of the batch.
+  @returns The index of the first spring.
+  */
+  std::size_t getColourBegin(std::size_t _colour) const;
+
+  /**
+  @brief Gets the index after the last spring in a colour batch.
+  @param[in] _colour The colour of the batch.
+  @returns The index after the last spring.
+  */
+  std::size_t getColourEnd(std::size_t _colour) const;
+
+  /**
+  @brief Computes the force of every spring once and adds it to the force accumulators of the attached particles.
+  Point A takes -F and point B takes +F, both are damped by their own velocity.
+  @param[in,out] _particles The particles the springs are attached to.
+  */
+  void computeForces(ParticleStore &_particles) const;
+
+  /**
+  @brief Computes the force of a range of springs and adds it to the force accumulators of the attached particles.
+  @param[in,out] _particles The particles the springs are attached to.
+  @param[in] _begin The index of the first spring to compute.
+  @param[in] _end The index after the last spring to compute.
+  */
+  void computeForces(ParticleStore &_particles, std::size_t _begin, std::size_t _end) const;
+
+  ///Raw access to the spring arrays for the solver kernels.
+  const std::uint32_t *getPointsA() const { return m_pointA.data(); }
+  const std::uint32_t *getPointsB() const { return m_pointB.data(); }
+  const std::uint8_t *getMaterials() const { return m_material.data(); }
+  const float *getMaterialStiffnesses() const { return m_materialStiffness.data(); }
+  const float *getMaterialRestLengths() const { return m_materialRestLength.data(); }
+
+  ///The most materials a SpringStore can hold.
+  static const std::size_t c_maxMaterials = 256;
+
+private:
+  ///The particle indices of the point A of the springs.
+  std::vector<std::uint32_t> m_pointA;
+  ///The particle indices of the point B of the springs.
+  std::vector<std::uint32_t> m_pointB;
+  ///The material indices of the springs.
+  std::vector<std::uint8_t> m_material;
+  ///The spring constants of the materials.
+  std::vector<float> m_materialStiffness;
+  ///The rest lengths of the materials.
+  std::vector<float> m_materialRestLength;
+  ///The spring constant of each material as a multiple of the spring constant of the first material.
+  std::vector<float> m_stiffnessRatio;
+  ///The rest length of each material as a multiple of the rest length of the first material.
+  std::vector<float> m_restLengthRatio;
+  ///The damping value of the springs.
+  float m_damping;
+  ///The index of the first spring of each colour batch followed by the number of springs.
+  std::vector<std::size_t> m_colourOffsets;
+
+  /**
+  @brief Finds the material with the same values, adding it if there is not one.
+  @param[in] _stiffness The spring constant of the material.
+  @param[in] _restLength The rest length of the material.
+  @returns The index of the material.
+  */
+  std::uint8_t findMaterial(float _stiffness, float _restLength);
+
+  /**
+  @brief Sets a value of one material and keeps the ratios to the first material up to date. The ratios are left
+  alone when the first material is zero so they are not lost.
+  @param[in,out] _values The values of the materials.
+  @param[in,out] _ratios The ratios of the values to the value of the first material.
+  @param[in] _material The index of the material.
+  @param[in] _value The new value of the material.
+  */
+  static void setMaterialValue(std::vector<float> &_values, std::vector<float> &_ratios, std::size_t _material,
+                               float _value);
+
+  /**
+  @brief Sets a value of the first material and sets the same value of the other materials from their ratios.
+  @param[in,out] _values The values of the materials.
+  @param[in] _ratios The ratios of the values to the value of the first material.
+  @param[in] _value The new value of the first material.
+  */
+  static void scaleMaterials(std::vector<float> &_values, const std::vector<float> &_ratios, float _value);
+};
+
+#endif // SPRINGSTORE_H_
@@ -0,0 +1,93 @@
+#ifndef SPSCQUEUE_H_
+#define SPSCQUEUE_H_
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+/// @file SpscQueue.h
+/// @brief A Class template of a bounded queue with one producer thread and one consumer thread that needs no locks.
+/// The values live in a ring buffer with a power of two size, the producer only writes the tail and the consumer only
+/// writes the head so each side does one atomic store per value. The head and tail are kept on separate cache lines so
+/// the two threads do not fight over them.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 29/08/19
+/// Revision History:
+/// Initial Version 29/08/19.
+template <typename T>
+class SpscQueue
+{
+public:
+  /**
+  @brief Constructs an empty SpscQueue.
+  @param[in] _capacity The number of values the queue can hold, this is rounded up to a power of two.
+  */
+  SpscQueue(std::size_t _capacity) : m_head(0), m_tail(0)
+  {
+    std::size_t size = 1;
+    while (size < _capacity)
+    {
+      size <<= 1;
+    }
+    m_values.resize(size);
+    m_mask = size - 1;
+  }
+
+  /**
+  @brief Adds a value to the back of the queue, only the producer thread may call this.
+  @param[in] _value The value to add.
+  @returns False if the queue is full and the value was not added.
+  */
+  bool push(const T &_value)
+  {
+    std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+    {
+      return false;
+    }
+    m_values[tail & m_mask] = _value;
+    //release so the consumer sees the value before the new tail
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+  @brief Takes the value at the front of the queue, only the consumer thread may call this.
+  @param[out] _value The value taken.
+  @returns False if the queue is empty.
+  */
+  bool pop(T &_value)
+  {
+    std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+    _value = m_values[head & m_mask];
+    //release so the producer only reuses the slot once the value has been read
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+  @brief Gets the number of values the queue can hold.
+  @returns The capacity.
+  */
+  std::size_t capacity() const
+  {
+    return m_values.size();
+  }
+
+private:
+  ///The ring buffer of values.
+  std::vector<T> m_values;
+  ///The mask that wraps an index into the ring buffer.
+  std::size_t m_mask;
+  ///The number of values taken, only written by the consumer.
+  alignas(64) std::atomic<std::size_t> m_head;
+  ///The number of values added, only written by the producer.
+  alignas(64) std::atomic<std::size_t> m_tail;
+};
+
+#endif // SPSCQUEUE_H_
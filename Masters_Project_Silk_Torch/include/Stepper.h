@@ -0,0 +1,385 @@
+#ifndef STEPPER_H_
+#define STEPPER_H_
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cmath>
+#include "glm/glm.hpp"
+
+#include "ParticleStore.h"
+#include "SpringStore.h"
+
+/// @file Stepper.h
+/// @brief The explicit steppers of a mass spring object, templated on an integrator policy and a scalar type.
+/// Every combination is compiled separately so the inner loops have no virtual calls or branches on the settings,
+/// the only virtual call is the one per step through AbstractStepper. The float symplectic Euler stepper is
+/// specialised to use the SimdKernels.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 25/08/19
+/// Revision History:
+/// Initial Version 25/08/19.
+
+/**
+@brief The integrators the explicit steppers can use.
+*/
+enum class IntegratorType
+{
+  SYMPLECTIC_EULER,
+  VERLET,
+  RK4
+};
+
+/**
+@brief The state of the particles in the precision of a Stepper, stored as a structure of arrays with one array per axis.
+*/
+template <typename Real>
+struct StepperState
+{
+  ///The positions of the particles.
+  std::vector<Real> m_pos[3];
+  ///The velocities of the particles.
+  std::vector<Real> m_vel[3];
+  ///The inverse masses of the particles, 0 for the locked particles so they never move.
+  std::vector<Real> m_invMass;
+  ///The force on each particle from the force accumulators, this is the same for every stage of a step.
+  std::vector<Real> m_constantForce[3];
+  ///The accelerations of the particles.
+  std::vector<Real> m_acc[3];
+  ///The positions of the current stage of a multi stage integrator.
+  std::vector<Real> m_stagePos[3];
+  ///The velocities of the current stage of a multi stage integrator.
+  std::vector<Real> m_stageVel[3];
+  ///The weighted sum of the stage velocities.
+  std::vector<Real> m_sumVel[3];
+  ///The weighted sum of the stage accelerations.
+  std::vector<Real> m_sumAcc[3];
+  ///A flag for if m_acc holds the acceleration at the current positions, used by Verlet.
+  bool m_hasAcc = false;
+  ///The external force m_acc was computed with, the acceleration is computed again when it changes.
+  Real m_accExternalForce[3] = {Real(0), Real(0), Real(0)};
+};
+
+/**
+@brief Computes the acceleration of every particle from the springs, the damping and the external forces.
+@param[in] _springs The springs.
+@param[in] _state The state holding the masses and the constant forces.
+@param[in] _pos The positions to compute the accelerations at.
+@param[in] _vel The velocities to compute the damping with.
+@param[in] _externalForce The external force acting on every particle.
+@param[out] _acc The accelerations.
+*/
+template <typename Real>
+void computeAccelerations(const SpringStore &_springs, const StepperState<Real> &_state, const std::vector<Real> (&_pos)[3],
+                          const std::vector<Real> (&_vel)[3], const Real (&_externalForce)[3], std::vector<Real> (&_acc)[3])
+{
+  std::size_t numParticles = _state.m_invMass.size();
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    for (std::size_t i = 0; i < numParticles; ++i)
+    {
+      _acc[axis][i] = _state.m_constantForce[axis][i] + _externalForce[axis];
+    }
+  }
+
+  Real damping = Real(_springs.getDamping());
+  for (std::size_t i = 0; i < _springs.size(); ++i)
+  {
+    std::uint32_t a = _springs.getPointA(i);
+    std::uint32_t b = _springs.getPointB(i);
+
+    //the same force as SpringStore::computeForces
+    Real d[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      d[axis] = _pos[axis][b] - _pos[axis][a];
+    }
+    Real springLength = std::sqrt((d[0] * d[0]) + (d[1] * d[1]) + (d[2] * d[2]));
+    Real springForceScale = (-Real(_springs.getStiffness(i)) * (springLength - Real(_springs.getRestLength(i)))) / springLength;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      Real force = d[axis] * springForceScale;
+      _acc[axis][a] += -force - (damping * _vel[axis][a]);
+      _acc[axis][b] += force - (damping * _vel[axis][b]);
+    }
+  }
+
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    for (std::size_t i = 0; i < numParticles; ++i)
+    {
+      _acc[axis][i] *= _state.m_invMass[i];
+    }
+  }
+}
+
+namespace Integrators
+{
+  /**
+  @brief Semi implicit Euler, the velocity is updated first and the position uses the new velocity.
+  One force evaluation per step, first order.
+  */
+  struct SymplecticEuler
+  {
+    template <typename Real>
+    static void step(StepperState<Real> &_state, const SpringStore &_springs, const Real (&_externalForce)[3], Real _dt)
+    {
+      computeAccelerations(_springs, _state, _state.m_pos, _state.m_vel, _externalForce, _state.m_acc);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        for (std::size_t i = 0; i < _state.m_invMass.size(); ++i)
+        {
+          _state.m_vel[axis][i] += _dt * _state.m_acc[axis][i];
+          _state.m_pos[axis][i] += _dt * _state.m_vel[axis][i];
+        }
+      }
+    }
+  };
+
+  /**
+  @brief Velocity Verlet, the acceleration at the end of a step is kept for the start of the next one.
+  One force evaluation per step, second order. The damping at the end of the step uses the predicted velocity. The
+  kept acceleration is dropped when the forces change, the spring settings reset the stepper when they change.
+  */
+  struct Verlet
+  {
+    template <typename Real>
+    static void step(StepperState<Real> &_state, const SpringStore &_springs, const Real (&_externalForce)[3], Real _dt)
+    {
+      std::size_t numParticles = _state.m_invMass.size();
+      bool sameExternalForce = (_state.m_accExternalForce[0] == _externalForce[0] &&
+                                _state.m_accExternalForce[1] == _externalForce[1] &&
+                                _state.m_accExternalForce[2] == _externalForce[2]);
+      if (!_state.m_hasAcc || !sameExternalForce)
+      {
+        computeAccelerations(_springs, _state, _state.m_pos, _state.m_vel, _externalForce, _state.m_acc);
+        _state.m_hasAcc = true;
+      }
+
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        for (std::size_t i = 0; i < numParticles; ++i)
+        {
+          _state.m_pos[axis][i] += (_dt * _state.m_vel[axis][i]) + (Real(0.5) * _dt * _dt * _state.m_acc[axis][i]);
+          _state.m_stageVel[axis][i] = _state.m_vel[axis][i] + (_dt * _state.m_acc[axis][i]);
+        }
+      }
+
+      computeAccelerations(_springs, _state, _state.m_pos, _state.m_stageVel, _externalForce, _state.m_sumAcc);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        for (std::size_t i = 0; i < numParticles; ++i)
+        {
+          _state.m_vel[axis][i] += Real(0.5) * _dt * (_state.m_acc[axis][i] + _state.m_sumAcc[axis][i]);
+        }
+        _state.m_acc[axis].swap(_state.m_sumAcc[axis]);
+        _state.m_accExternalForce[axis] = _externalForce[axis];
+      }
+    }
+  };
+
+  /**
+  @brief Classic fourth order Runge-Kutta on the positions and velocities.
+  Four force evaluations per step, fourth order.
+  */
+  struct Rk4
+  {
+    template <typename Real>
+    static void step(StepperState<Real> &_state, const SpringStore &_springs, const Real (&_externalForce)[3], Real _dt)
+    {
+      std::size_t numParticles = _state.m_invMass.size();
+      Real halfDt = Real(0.5) * _dt;
+
+      //the first stage is at the start of the step
+      computeAccelerations(_springs, _state, _state.m_pos, _state.m_vel, _externalForce, _state.m_acc);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        for (std::size_t i = 0; i < numParticles; ++i)
+        {
+          _state.m_sumVel[axis][i] = _state.m_vel[axis][i];
+          _state.m_sumAcc[axis][i] = _state.m_acc[axis][i];
+          _state.m_stageVel[axis][i] = _state.m_vel[axis][i];
+        }
+      }
+
+      //the middle stages are weighted by 2 and the last by 1
+      const Real stageDt[3] = {halfDt, halfDt, _dt};
+      const Real stageWeight[3] = {Real(2), Real(2), Real(1)};
+      for (int stage = 0; stage < 3; ++stage)
+      {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          for (std::size_t i = 0; i < numParticles; ++i)
+          {
+            _state.m_stagePos[axis][i] = _state.m_pos[axis][i] + (stageDt[stage] * _state.m_stageVel[axis][i]);
+            _state.m_stageVel[axis][i] = _state.m_vel[axis][i] + (stageDt[stage] * _state.m_acc[axis][i]);
+          }
+        }
+        computeAccelerations(_springs, _state, _state.m_stagePos, _state.m_stageVel, _externalForce, _state.m_acc);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          for (std::size_t i = 0; i < numParticles; ++i)
+          {
+            _state.m_sumVel[axis][i] += stageWeight[stage] * _state.m_stageVel[axis][i];
+            _state.m_sumAcc[axis][i] += stageWeight[stage] * _state.m_acc[axis][i];
+          }
+        }
+      }
+
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        for (std::size_t i = 0; i < numParticles; ++i)
+        {
+          _state.m_pos[axis][i] += (_dt / Real(6)) * _state.m_sumVel[axis][i];
+          _state.m_vel[axis][i] += (_dt / Real(6)) * _state.m_sumAcc[axis][i];
+        }
+      }
+    }
+  };
+}
+
+/**
+@brief The interface the MassSpringObject steps through, one virtual call per step.
+*/
+class AbstractStepper
+{
+public:
+  /**
+  @brief Destructs the AbstractStepper.
+  */
+  virtual ~AbstractStepper();
+
+  /**
+  @brief Steps the particles. The force accumulators of the particles are added to the external force, they must not
+  hold the spring forces.
+  @param[in] _springs The springs.
+  @param[in,out] _particles The particles the springs are attached to.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time.
+  */
+  virtual void step(const SpringStore &_springs, ParticleStore &_particles, glm::vec3 _externalForce, float _dt) = 0;
+
+  /**
+  @brief Drops any state kept between steps, this must be called when the particles are changed outside of the stepper.
+  */
+  virtual void reset() = 0;
+};
+
+/**
+@brief An explicit stepper for one integrator policy and scalar type. The particles are kept in the scalar type between
+steps so the double steppers do not lose their precision to the float ParticleStore.
+*/
+template <typename Integrator, typename Real>
+class Stepper : public AbstractStepper
+{
+public:
+  /**
+  @brief Steps the particles with the Integrator in the Real precision.
+  @param[in] _springs The springs.
+  @param[in,out] _particles The particles the springs are attached to.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time.
+  */
+  void step(const SpringStore &_springs, ParticleStore &_particles, glm::vec3 _externalForce, float _dt) override
+  {
+    std::size_t numParticles = _particles.size();
+    if (m_state.m_invMass.size() != numParticles)
+    {
+      load(_particles);
+    }
+
+    //a batch of flames puts the external force of each flame in the accumulators, the acceleration kept by Verlet is
+    //dropped when they change
+    for (std::size_t i = 0; i < numParticles; ++i)
+    {
+      glm::vec3 force = _particles.getForce(i);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        if (m_state.m_constantForce[axis][i] != Real(force[axis]))
+        {
+          m_state.m_constantForce[axis][i] = Real(force[axis]);
+          m_state.m_hasAcc = false;
+        }
+      }
+    }
+
+    const Real externalForce[3] = {Real(_externalForce.x), Real(_externalForce.y), Real(_externalForce.z)};
+    Integrator::step(m_state, _springs, externalForce, Real(_dt));
+
+    for (std::size_t i = 0; i < numParticles; ++i)
+    {
+      _particles.setPos(i, glm::vec3(float(m_state.m_pos[0][i]), float(m_state.m_pos[1][i]), float(m_state.m_pos[2][i])));
+      _particles.setVel(i, glm::vec3(float(m_state.m_vel[0][i]), float(m_state.m_vel[1][i]), float(m_state.m_vel[2][i])));
+    }
+  }
+
+  /**
+  @brief Drops the particles kept in the Real precision so they are loaded again on the next step.
+  */
+  void reset() override
+  {
+    m_state.m_invMass.clear();
+    m_state.m_hasAcc = false;
+  }
+
+private:
+  ///The particles in the Real precision.
+  StepperState<Real> m_state;
+
+  /**
+  @brief Loads the particles into the Real precision.
+  @param[in] _particles The particles.
+  */
+  void load(const ParticleStore &_particles)
+  {
+    std::size_t numParticles = _particles.size();
+    m_state.m_invMass.resize(numParticles);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      m_state.m_pos[axis].resize(numParticles);
+      m_state.m_vel[axis].resize(numParticles);
+      m_state.m_constantForce[axis].resize(numParticles);
+      m_state.m_acc[axis].resize(numParticles);
+      m_state.m_stagePos[axis].resize(numParticles);
+      m_state.m_stageVel[axis].resize(numParticles);
+      m_state.m_sumVel[axis].resize(numParticles);
+      m_state.m_sumAcc[axis].resize(numParticles);
+    }
+
+    for (std::size_t i = 0; i < numParticles; ++i)
+    {
+      glm::vec3 pos = _particles.getPos(i);
+      glm::vec3 vel = _particles.getVel(i);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        m_state.m_pos[axis][i] = Real(pos[axis]);
+        m_state.m_vel[axis][i] = Real(vel[axis]);
+      }
+      m_state.m_invMass[i] = _particles.getIsLocked(i) ? Real(0) : Real(_particles.getInvMass()[i]);
+    }
+    m_state.m_hasAcc = false;
+  }
+};
+
+/**
+@brief The float symplectic Euler stepper works on the ParticleStore directly with the SimdKernels.
+*/
+template <>
+void Stepper<Integrators::SymplecticEuler, float>::step(const SpringStore &_springs, ParticleStore &_particles, glm::vec3 _externalForce, float _dt);
+
+/**
+@brief The float symplectic Euler stepper keeps no state.
+*/
+template <>
+void Stepper<Integrators::SymplecticEuler, float>::reset();
+
+/**
+@brief Creates the stepper for an integrator and precision.
+@param[in] _integrator The integrator.
+@param[in] _doublePrecision True to step in double precision, false for float.
+@returns The new stepper.
+*/
+std::unique_ptr<AbstractStepper> createStepper(IntegratorType _integrator, bool _doublePrecision);
+
+#endif // STEPPER_H_
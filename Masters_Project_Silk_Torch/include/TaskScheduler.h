@@ -0,0 +1,130 @@
+#ifndef TASKSCHEDULER_H_
+#define TASKSCHEDULER_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+/// @file TaskScheduler.h
+/// @brief A Class that contains a work stealing pool of worker threads for running the solver across all of the cores.
+/// Each worker has its own deque of tasks, it takes work from the back of its own deque and when that is empty it steals
+/// from the front of the others. Threads that are not workers put their tasks in a shared deque that the workers steal from.
+/// @author Jamie Slowgrove
+/// @version 2.0
+/// @date 19/08/19
+/// Revision History:
+/// Initial Version 19/08/19.
+/// New Version 20/08/19 with work stealing and a setting for the number of threads.
+class TaskScheduler
+{
+public:
+  /**
+  @brief Gets the shared TaskScheduler, this is created on first use with one thread per core.
+  @returns A reference to the TaskScheduler.
+  */
+  static TaskScheduler &instance();
+
+  /**
+  @brief Constructs the TaskScheduler.
+  @param[in] _numThreads The number of threads that run tasks, including the calling thread. 0 uses one per core.
+  */
+  TaskScheduler(unsigned int _numThreads);
+
+  /**
+  @brief Destructs the TaskScheduler, this waits for the worker threads to finish.
+  */
+  ~TaskScheduler();
+
+  /**
+  @brief Gets the number of threads that run tasks, including the calling thread.
+  @returns The number of threads.
+  */
+  unsigned int getNumThreads() const;
+
+  /**
+  @brief Sets the number of threads that run tasks, including the calling thread. The workers are restarted so this
+  must not be called while a parallelFor is running.
+  @param[in] _numThreads The number of threads. 0 uses one per core.
+  */
+  void setNumThreads(unsigned int _numThreads);
+
+  /**
+  @brief Splits a range into chunks and runs them across the threads. The calling thread works on the chunks too and
+  this returns once every chunk is finished. This can be called from inside another parallelFor, idle workers steal
+  the inner chunks.
+  @param[in] _begin The start of the range.
+  @param[in] _end The end of the range.
+  @param[in] _grainSize The smallest number of items in a chunk.
+  @param[in] _function The function to run on each chunk, this is given the chunk begin and end.
+  */
+  void parallelFor(std::size_t _begin, std::size_t _end, std::size_t _grainSize,
+                   const std::function<void(std::size_t, std::size_t)> &_function);
+
+private:
+  ///A structure for the deque of tasks of one thread.
+  struct TaskQueue
+  {
+    ///The mutex for the tasks.
+    std::mutex m_mutex;
+    ///The tasks waiting to be run.
+    std::deque<std::function<void()>> m_tasks;
+  };
+
+  ///The worker threads.
+  std::vector<std::thread> m_workers;
+  ///The task deques, the first is shared by the threads that are not workers and the rest are one per worker.
+  std::vector<std::unique_ptr<TaskQueue>> m_queues;
+  ///The number of tasks waiting in all of the deques.
+  std::atomic<std::size_t> m_numPending;
+  ///The mutex the idle workers sleep on.
+  std::mutex m_sleepMutex;
+  ///The condition the idle workers wait on for new tasks.
+  std::condition_variable m_taskAdded;
+  ///A flag for if the workers should stop.
+  bool m_stopping;
+
+  /**
+  @brief Starts the worker threads.
+  @param[in] _numThreads The number of threads that run tasks, including the calling thread. 0 uses one per core.
+  */
+  void startWorkers(unsigned int _numThreads);
+
+  /**
+  @brief Stops and joins the worker threads.
+  */
+  void stopWorkers();
+
+  /**
+  @brief The loop run by each worker thread.
+  @param[in] _queueIndex The index of the deque of the worker.
+  */
+  void workerLoop(std::size_t _queueIndex);
+
+  /**
+  @brief Gets the index of the deque of the calling thread.
+  @returns The index of the deque, 0 if the calling thread is not a worker of this TaskScheduler.
+  */
+  std::size_t getQueueIndex() const;
+
+  /**
+  @brief Adds a number of copies of a task to the deque of the calling thread and wakes the workers.
+  @param[in] _task The task.
+  @param[in] _count The number of copies.
+  */
+  void push(const std::function<void()> &_task, std::size_t _count);
+
+  /**
+  @brief Runs one task, taking it from the back of the given deque or stealing it from the front of another.
+  @param[in] _queueIndex The index of the deque of the calling thread.
+  @returns True if a task was run.
+  */
+  bool runTask(std::size_t _queueIndex);
+};
+
+#endif // TASKSCHEDULER_H_
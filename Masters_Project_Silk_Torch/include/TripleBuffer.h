@@ -0,0 +1,90 @@
+#ifndef TRIPLEBUFFER_H_
+#define TRIPLEBUFFER_H_
+
+#include <array>
+#include <atomic>
+
+/// @file TripleBuffer.h
+/// @brief A Class template that hands values from one writer thread to one reader thread without locks.
+/// The writer fills the back buffer and publishes it by swapping it with the middle buffer, the reader takes the middle
+/// buffer by swapping it with the front buffer when a new one has been published. Neither side ever waits for the
+/// other, the reader always sees the newest complete value and values it was too slow to see are skipped.
+/// The three buffers are reused so a value that keeps its memory, such as a std::vector, stops allocating once warm.
+/// @author Jamie Slowgrove
+/// @version 1.0
+/// @date 28/08/19
+/// Revision History:
+/// Initial Version 28/08/19.
+template <typename T>
+class TripleBuffer
+{
+public:
+  /**
+  @brief Constructs a TripleBuffer with nothing published.
+  */
+  TripleBuffer() : m_backIndex(0), m_frontIndex(1), m_middle(2)
+  {
+  }
+
+  /**
+  @brief Gets the buffer the writer fills, only the writer thread may call this.
+  @returns A reference to the back buffer, this is valid until the next publish.
+  */
+  T &getWriteBuffer()
+  {
+    return m_buffers[m_backIndex];
+  }
+
+  /**
+  @brief Publishes the back buffer to the reader and takes the old middle buffer as the new back buffer, only the
+  writer thread may call this.
+  */
+  void publish()
+  {
+    //release so the reader sees everything written to the buffer before the swap
+    unsigned int old = m_middle.exchange(m_backIndex | c_freshBit, std::memory_order_acq_rel);
+    m_backIndex = old & c_indexMask;
+  }
+
+  /**
+  @brief Takes the newest published buffer as the front buffer if there is one, only the reader thread may call this.
+  @returns True if a new buffer was taken.
+  */
+  bool update()
+  {
+    if (!(m_middle.load(std::memory_order_relaxed) & c_freshBit))
+    {
+      return false;
+    }
+    //acquire so everything the writer put in the buffer is seen
+    unsigned int old = m_middle.exchange(m_frontIndex, std::memory_order_acq_rel);
+    m_frontIndex = old & c_indexMask;
+    return true;
+  }
+
+  /**
+  @brief Gets the buffer the reader uses, only the reader thread may call this.
+  @returns A reference to the front buffer, this is valid until the next update.
+  */
+  const T &getReadBuffer() const
+  {
+    return m_buffers[m_frontIndex];
+  }
+
+private:
+  ///The flag set in the middle index when it holds a buffer the reader has not taken.
+  static const unsigned int c_freshBit = 4;
+  ///The mask of the buffer index in the middle index.
+  static const unsigned int c_indexMask = 3;
+
+  ///The three buffers.
+  std::array<T, 3> m_buffers;
+  ///The index of the buffer the writer fills, only used by the writer.
+  unsigned int m_backIndex;
+  ///The index of the buffer the reader uses, only used by the reader.
+  unsigned int m_frontIndex;
+  ///The index of the buffer between them and the flag for if it is newer than the front buffer.
+  std::atomic<unsigned int> m_middle;
+};
+
+#endif // TRIPLEBUFFER_H_
@@ -0,0 +1,112 @@
+#ifndef XPBDSOLVER_H_
+#define XPBDSOLVER_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "glm/glm.hpp"
+
+#include "ParticleStore.h"
+#include "SpringStore.h"
+#include "ConstraintStore.h"
+
+/// @file XpbdSolver.h
+/// @brief A Class that integrates the particles of a mass spring object with extended position based dynamics.
+/// The springs are turned into distance constraints with a compliance of 1 / k, straight runs of springs get bending
+/// constraints and the locked particles get pins. The constraints are projected with Gauss-Seidel over their colour
+/// batches, this is stable at any time step.
+/// @author Jamie Slowgrove
+/// @version 1.1
+/// @date 02/09/19
+/// Revision History:
+/// Initial Version 24/08/19.
+/// Modified Version 02/09/19 to find the straight runs from the points of the grid so any particle order works.
+class XpbdSolver
+{
+public:
+  /**
+  @brief Constructs an XpbdSolver with 10 iterations per step and a bending compliance of 0.1f.
+  */
+  XpbdSolver();
+
+  /**
+  @brief Destructs the XpbdSolver.
+  */
+  ~XpbdSolver();
+
+  /**
+  @brief Integrates the particles with XPBD. The force accumulators of the particles are added to the external force,
+  they must not hold the spring forces.
+  @param[in] _springs The springs to build the constraints from.
+  @param[in,out] _particles The particles the springs are attached to.
+  @param[in] _externalForce The external force acting on every particle.
+  @param[in] _dt The delta time.
+  */
+  void integrate(const SpringStore &_springs, ParticleStore &_particles, glm::vec3 _externalForce, float _dt);
+
+  /**
+  @brief Marks the constraints as out of date, this should be called when the springs or grid change.
+  */
+  void invalidate();
+
+  /**
+  @brief Sets the number of constraint iterations per step.
+  @param[in] _iterations The number of iterations.
+  */
+  void setIterations(unsigned int _iterations);
+
+  /**
+  @brief Gets the number of constraint iterations per step.
+  @returns The number of iterations.
+  */
+  unsigned int getIterations() const;
+
+  /**
+  @brief Sets the point of the grid each particle belongs to. The straight runs of springs for the bending constraints
+  are found from the steps between these points, so they are the same whatever order the particles are stored in.
+  @param[in] _points The row major point of each particle, empty to use the particle indices when they are stored in
+  row major order.
+  */
+  void setPoints(const std::vector<std::uint32_t> &_points);
+
+  /**
+  @brief Sets the compliance of the bending constraints.
+  @param[in] _compliance The inverse bending stiffness.
+  */
+  void setBendingCompliance(float _compliance);
+
+  /**
+  @brief Gets the constraints built from the springs.
+  @returns A reference to the ConstraintStore.
+  */
+  const ConstraintStore &getConstraints() const;
+
+private:
+  ///The constraints built from the springs.
+  ConstraintStore m_constraints;
+  ///A flag for if the constraints match the current springs.
+  bool m_built;
+  ///The number of particles the constraints were built for.
+  std::size_t m_builtParticles;
+  ///The number of springs the constraints were built for.
+  std::size_t m_builtSprings;
+  ///The positions of the particles at the start of the step.
+  std::vector<glm::vec3> m_previousPositions;
+  ///The number of springs attached to each particle, for the damping.
+  std::vector<float> m_numAttached;
+  ///The number of constraint iterations per step.
+  unsigned int m_iterations;
+  ///The compliance of the bending constraints.
+  float m_bendingCompliance;
+  ///The row major point of the grid of each particle, empty when the particle indices are the points.
+  std::vector<std::uint32_t> m_points;
+
+  /**
+  @brief Builds the distance, bending and pin constraints from the springs and the locked particles.
+  @param[in] _springs The springs.
+  @param[in] _particles The particles the springs are attached to.
+  */
+  void build(const SpringStore &_springs, const ParticleStore &_particles);
+};
+
+#endif // XPBDSOLVER_H_
@@ -0,0 +1,14 @@
+#version 330 core
+// the flame textures, one a layer
+uniform sampler2DArray tex;
+// the vertex UV
+in vec2 vertUV;
+// the texture layer of the flame
+flat in float vertLayer;
+// the final fragment colour
+layout (location =0) out vec4 outColour;
+void main ()
+{
+ // set the fragment colour to the texture of the flame
+ outColour = texture(tex,vec3(vertUV,vertLayer));
+}
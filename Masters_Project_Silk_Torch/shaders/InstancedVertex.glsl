@@ -0,0 +1,32 @@
+#version 330 core
+
+/// @brief MVP passed from app
+uniform mat4 MVP;
+// the positions of every flame, three floats a vertex and one flame after the other
+uniform samplerBuffer positions;
+// the number of vertices in each flame
+uniform int numVertices;
+// second attribute the UV values shared by every flame
+layout (location=2) in vec2 inUV;
+// the transformation matrix of the flame, this takes the locations 3 to 6
+layout (location=3) in mat4 inTransform;
+// the texture layer of the flame
+layout (location=7) in float inLayer;
+// we use this to pass the UV values to the frag shader
+out vec2 vertUV;
+// we use this to pass the texture layer to the frag shader
+flat out float vertLayer;
+
+void main()
+{
+  // fetch the position of this vertex of this flame
+  int first = (gl_InstanceID * numVertices + gl_VertexID) * 3;
+  vec3 vert = vec3(texelFetch(positions, first).r,
+                   texelFetch(positions, first + 1).r,
+                   texelFetch(positions, first + 2).r);
+  // calculate the vertex position
+  gl_Position = MVP*inTransform*vec4(vert, 1.0);
+  // pass the UV values and layer to the frag shader
+  vertUV=inUV.st;
+  vertLayer=inLayer;
+}
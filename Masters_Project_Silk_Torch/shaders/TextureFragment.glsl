@@ -1,12 +1,14 @@
 #version 330 core
-// this is a pointer to the current 2D texture object
-uniform sampler2D tex;
+// this is a pointer to the flame textures, one a layer
+uniform sampler2DArray tex;
+// the texture layer of the flame
+uniform int layer;
 // the vertex UV
 in vec2 vertUV;
 // the final fragment colour
 layout (location =0) out vec4 outColour;
 void main ()
 {
- // set the fragment colour to the current texture
- outColour = texture(tex,vertUV);
+ // set the fragment colour to the texture of the flame
+ outColour = texture(tex,vec3(vertUV,layer));
 }
@@ -0,0 +1,165 @@
+#include "AdaptiveStepController.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+AdaptiveStepController::AdaptiveStepController() : m_maxFrequencySquared(0.0f), m_minRestLength(0.0f), m_built(false),
+  m_builtParticles(0), m_builtSprings(0), m_numSubsteps(1), m_stableDt(0.0f), m_maxSubsteps(64), m_safetyFactor(0.5f),
+  m_maxTravel(0.25f)
+{
+}
+
+AdaptiveStepController::~AdaptiveStepController()
+{
+}
+
+unsigned int AdaptiveStepController::computeNumSubsteps(const SpringStore &_springs, const ParticleStore &_particles, glm::vec3 _externalForce, float _dt)
+{
+  if (!m_built || m_builtParticles != _particles.size() || m_builtSprings != _springs.size())
+  {
+    build(_springs, _particles);
+  }
+  return pickNumSubsteps(_particles, _externalForce, _dt);
+}
+
+unsigned int AdaptiveStepController::computeNumSubsteps(const GridStencil &_stencil, const ParticleStore &_particles, glm::vec3 _externalForce, float _dt)
+{
+  if (!m_built || m_builtParticles != _particles.size())
+  {
+    std::vector<float> stiffness;
+    _stencil.computeStiffnessSums(stiffness);
+    m_minRestLength = _stencil.getMinRestLength();
+    build(stiffness, _particles);
+    m_builtSprings = 0;
+  }
+  return pickNumSubsteps(_particles, _externalForce, _dt);
+}
+
+unsigned int AdaptiveStepController::pickNumSubsteps(const ParticleStore &_particles, glm::vec3 _externalForce, float _dt)
+{
+  //symplectic Euler is stable while the highest frequency times the step is under 2
+  float stableDt = std::numeric_limits<float>::max();
+  if (m_maxFrequencySquared > 0.0f)
+  {
+    stableDt = m_safetyFactor * 2.0f / std::sqrt(m_maxFrequencySquared);
+  }
+
+  //the fastest particle at the end of the step, a gust shows up in the forces before the velocities
+  const float *velX = _particles.getVelX();
+  const float *velY = _particles.getVelY();
+  const float *velZ = _particles.getVelZ();
+  const float *forceX = _particles.getForceX();
+  const float *forceY = _particles.getForceY();
+  const float *forceZ = _particles.getForceZ();
+  const float *invMass = _particles.getInvMass();
+  const std::uint8_t *locked = _particles.getLocked();
+  float maxSpeedSquared = 0.0f;
+  for (std::size_t i = 0; i < _particles.size(); ++i)
+  {
+    if (locked[i])
+    {
+      continue;
+    }
+    float scale = _dt * invMass[i];
+    float x = velX[i] + (scale * (forceX[i] + _externalForce.x));
+    float y = velY[i] + (scale * (forceY[i] + _externalForce.y));
+    float z = velZ[i] + (scale * (forceZ[i] + _externalForce.z));
+    maxSpeedSquared = std::max(maxSpeedSquared, (x * x) + (y * y) + (z * z));
+  }
+  if (maxSpeedSquared > 0.0f && m_minRestLength > 0.0f)
+  {
+    stableDt = std::min(stableDt, m_maxTravel * m_minRestLength / std::sqrt(maxSpeedSquared));
+  }
+  m_stableDt = stableDt;
+
+  //only split the step when it is over the limit
+  m_numSubsteps = 1;
+  if (_dt > stableDt)
+  {
+    m_numSubsteps = unsigned(std::min(std::ceil(_dt / stableDt), float(m_maxSubsteps)));
+  }
+  return m_numSubsteps;
+}
+
+void AdaptiveStepController::invalidate()
+{
+  m_built = false;
+}
+
+unsigned int AdaptiveStepController::getNumSubsteps() const
+{
+  return m_numSubsteps;
+}
+
+float AdaptiveStepController::getStableDt() const
+{
+  return m_stableDt;
+}
+
+void AdaptiveStepController::setMaxSubsteps(unsigned int _maxSubsteps)
+{
+  m_maxSubsteps = std::max(_maxSubsteps, 1u);
+}
+
+unsigned int AdaptiveStepController::getMaxSubsteps() const
+{
+  return m_maxSubsteps;
+}
+
+void AdaptiveStepController::setSafetyFactor(float _safetyFactor)
+{
+  m_safetyFactor = _safetyFactor;
+}
+
+void AdaptiveStepController::setMaxTravel(float _maxTravel)
+{
+  m_maxTravel = _maxTravel;
+}
+
+void AdaptiveStepController::build(const SpringStore &_springs, const ParticleStore &_particles)
+{
+  //sum the spring constants at each particle
+  std::vector<float> stiffness(_particles.size(), 0.0f);
+  const std::uint32_t *pointA = _springs.getPointsA();
+  const std::uint32_t *pointB = _springs.getPointsB();
+  const std::uint8_t *materials = _springs.getMaterials();
+  const float *materialStiffness = _springs.getMaterialStiffnesses();
+  for (std::size_t i = 0; i < _springs.size(); ++i)
+  {
+    stiffness[pointA[i]] += materialStiffness[materials[i]];
+    stiffness[pointB[i]] += materialStiffness[materials[i]];
+  }
+
+  //the shortest spring is the shortest material
+  m_minRestLength = 0.0f;
+  for (std::size_t i = 0; i < _springs.getNumMaterials(); ++i)
+  {
+    float restLength = _springs.getMaterialRestLength(std::uint8_t(i));
+    if (m_minRestLength <= 0.0f || (restLength > 0.0f && restLength < m_minRestLength))
+    {
+      m_minRestLength = restLength;
+    }
+  }
+
+  build(stiffness, _particles);
+  m_builtSprings = _springs.size();
+}
+
+void AdaptiveStepController::build(const std::vector<float> &_stiffness, const ParticleStore &_particles)
+{
+  //Gershgorin bound of the largest eigenvalue of M^-1 K, the locked particles do not move so do not count
+  const float *invMass = _particles.getInvMass();
+  const std::uint8_t *locked = _particles.getLocked();
+  m_maxFrequencySquared = 0.0f;
+  for (std::size_t i = 0; i < _particles.size(); ++i)
+  {
+    if (!locked[i])
+    {
+      m_maxFrequencySquared = std::max(m_maxFrequencySquared, 2.0f * invMass[i] * _stiffness[i]);
+    }
+  }
+
+  m_built = true;
+  m_builtParticles = _particles.size();
+}
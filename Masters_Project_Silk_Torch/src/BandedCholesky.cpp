@@ -0,0 +1,112 @@
+#include "BandedCholesky.h"
+#include <algorithm>
+#include <cmath>
+
+BandedCholesky::BandedCholesky() : m_size(0), m_bandwidth(0)
+{
+}
+
+BandedCholesky::~BandedCholesky()
+{
+}
+
+void BandedCholesky::resize(std::size_t _size, std::size_t _bandwidth)
+{
+  m_size = _size;
+  m_bandwidth = _bandwidth;
+  m_band.assign(_size * (_bandwidth + 1), 0.0);
+}
+
+void BandedCholesky::add(std::size_t _row, std::size_t _column, double _value)
+{
+  m_band[getIndex(_row, _column)] += _value;
+}
+
+bool BandedCholesky::factorise()
+{
+  for (std::size_t i = 0; i < m_size; ++i)
+  {
+    std::size_t rowBegin = (i > m_bandwidth) ? i - m_bandwidth : 0;
+    double *row = getRow(i);
+    for (std::size_t j = rowBegin; j <= i; ++j)
+    {
+      //take away the products of the factored values to the left of the diagonal
+      const double *otherRow = getRow(j);
+      std::size_t columnBegin = std::max(rowBegin, (j > m_bandwidth) ? j - m_bandwidth : 0);
+      double sum = row[j];
+      for (std::size_t k = columnBegin; k < j; ++k)
+      {
+        sum -= row[k] * otherRow[k];
+      }
+
+      if (i == j)
+      {
+        if (sum <= 0.0)
+        {
+          return false;
+        }
+        row[i] = std::sqrt(sum);
+      }
+      else
+      {
+        row[j] = sum / otherRow[j];
+      }
+    }
+  }
+  return true;
+}
+
+void BandedCholesky::solve(std::vector<double> &_x) const
+{
+  //forward substitution with L, a row at a time
+  for (std::size_t i = 0; i < m_size; ++i)
+  {
+    std::size_t rowBegin = (i > m_bandwidth) ? i - m_bandwidth : 0;
+    const double *row = getRow(i);
+    double sum = _x[i];
+    for (std::size_t k = rowBegin; k < i; ++k)
+    {
+      sum -= row[k] * _x[k];
+    }
+    _x[i] = sum / row[i];
+  }
+
+  //back substitution with L^T, the rows of L are the columns of L^T so each solved value is taken away from the
+  //values above it
+  for (std::size_t i = m_size; i-- > 0;)
+  {
+    std::size_t rowBegin = (i > m_bandwidth) ? i - m_bandwidth : 0;
+    const double *row = getRow(i);
+    double value = _x[i] / row[i];
+    _x[i] = value;
+    for (std::size_t k = rowBegin; k < i; ++k)
+    {
+      _x[k] -= row[k] * value;
+    }
+  }
+}
+
+std::size_t BandedCholesky::size() const
+{
+  return m_size;
+}
+
+std::size_t BandedCholesky::getBandwidth() const
+{
+  return m_bandwidth;
+}
+
+std::size_t BandedCholesky::getIndex(std::size_t _row, std::size_t _column) const
+{
+  return (_row * (m_bandwidth + 1)) + (_column + m_bandwidth - _row);
+}
+
+double *BandedCholesky::getRow(std::size_t _row)
+{
+  return m_band.data() + getIndex(_row, 0);
+}
+
+const double *BandedCholesky::getRow(std::size_t _row) const
+{
+  return m_band.data() + getIndex(_row, 0);
+}
@@ -1,6 +0,0 @@
-#include "Constraint.h"
-
-Constraint::~Constraint()
-{
-
-}
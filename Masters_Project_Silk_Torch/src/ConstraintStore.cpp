@@ -0,0 +1,326 @@
+#include "ConstraintStore.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  /**
+  @brief Gives each constraint the lowest colour not already used at any of its particles, the same greedy colouring
+  as the springs.
+  @param[in] _points The particle arrays of the constraints, one array per point of a constraint.
+  @param[out] _order The new index of each constraint so the colours are contiguous.
+  @returns The index of the first constraint of each colour followed by the number of constraints.
+  */
+  std::vector<std::size_t> colourConstraints(const std::vector<const std::vector<std::uint32_t> *> &_points, std::vector<std::size_t> &_order)
+  {
+    std::size_t numConstraints = _points[0]->size();
+    std::size_t numParticles = 0;
+    for (auto points : _points)
+    {
+      for (auto point : *points)
+      {
+        numParticles = std::max<std::size_t>(numParticles, point + 1u);
+      }
+    }
+
+    std::vector<std::uint64_t> usedColours(numParticles, 0);
+    std::vector<std::uint8_t> colours(numConstraints);
+    std::size_t numColours = 0;
+    for (std::size_t i = 0; i < numConstraints; ++i)
+    {
+      std::uint64_t used = 0;
+      for (auto points : _points)
+      {
+        used |= usedColours[(*points)[i]];
+      }
+      std::uint8_t colour = 0;
+      while (colour < 63 && (used & (std::uint64_t(1) << colour)))
+      {
+        ++colour;
+      }
+      colours[i] = colour;
+      for (auto points : _points)
+      {
+        usedColours[(*points)[i]] |= std::uint64_t(1) << colour;
+      }
+      numColours = std::max<std::size_t>(numColours, colour + 1u);
+    }
+
+    //count the constraints of each colour to get the start of each batch
+    std::vector<std::size_t> offsets(numColours + 1, 0);
+    for (std::size_t i = 0; i < numConstraints; ++i)
+    {
+      offsets[colours[i] + 1]++;
+    }
+    for (std::size_t c = 0; c < numColours; ++c)
+    {
+      offsets[c + 1] += offsets[c];
+    }
+
+    //keep the order of the constraints within a batch
+    std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+    _order.resize(numConstraints);
+    for (std::size_t i = 0; i < numConstraints; ++i)
+    {
+      _order[i] = next[colours[i]]++;
+    }
+    return offsets;
+  }
+
+  /**
+  @brief Moves each value to its new index.
+  @param[in,out] _values The values to move.
+  @param[in] _order The new index of each value.
+  */
+  template <typename T>
+  void reorder(std::vector<T> &_values, const std::vector<std::size_t> &_order)
+  {
+    std::vector<T> reordered(_values.size());
+    for (std::size_t i = 0; i < _values.size(); ++i)
+    {
+      reordered[_order[i]] = _values[i];
+    }
+    _values.swap(reordered);
+  }
+}
+
+ConstraintStore::ConstraintStore()
+{
+}
+
+ConstraintStore::~ConstraintStore()
+{
+}
+
+void ConstraintStore::clear()
+{
+  m_distanceA.clear();
+  m_distanceB.clear();
+  m_distanceRestLength.clear();
+  m_distanceCompliance.clear();
+  m_distanceLambda.clear();
+  m_distanceColourOffsets.clear();
+  m_pinPoint.clear();
+  m_pinPosition.clear();
+  m_pinCompliance.clear();
+  m_pinLambda.clear();
+  m_bendingA.clear();
+  m_bendingB.clear();
+  m_bendingC.clear();
+  m_bendingRestLength.clear();
+  m_bendingCompliance.clear();
+  m_bendingLambda.clear();
+  m_bendingColourOffsets.clear();
+}
+
+void ConstraintStore::addDistance(std::uint32_t _pointA, std::uint32_t _pointB, float _restLength, float _compliance)
+{
+  m_distanceA.push_back(_pointA);
+  m_distanceB.push_back(_pointB);
+  m_distanceRestLength.push_back(_restLength);
+  m_distanceCompliance.push_back(_compliance);
+  m_distanceLambda.push_back(0.0f);
+  m_distanceColourOffsets.clear();
+}
+
+void ConstraintStore::addPin(std::uint32_t _point, glm::vec3 _position, float _compliance)
+{
+  m_pinPoint.push_back(_point);
+  m_pinPosition.push_back(_position);
+  m_pinCompliance.push_back(_compliance);
+  m_pinLambda.push_back(0.0f);
+}
+
+void ConstraintStore::addBending(std::uint32_t _pointA, std::uint32_t _pointB, std::uint32_t _pointC, float _restLength, float _compliance)
+{
+  m_bendingA.push_back(_pointA);
+  m_bendingB.push_back(_pointB);
+  m_bendingC.push_back(_pointC);
+  m_bendingRestLength.push_back(_restLength);
+  m_bendingCompliance.push_back(_compliance);
+  m_bendingLambda.push_back(0.0f);
+  m_bendingColourOffsets.clear();
+}
+
+std::size_t ConstraintStore::getNumDistances() const
+{
+  return m_distanceA.size();
+}
+
+std::size_t ConstraintStore::getNumPins() const
+{
+  return m_pinPoint.size();
+}
+
+std::size_t ConstraintStore::getNumBendings() const
+{
+  return m_bendingA.size();
+}
+
+void ConstraintStore::setDistanceCompliance(float _compliance)
+{
+  std::fill(m_distanceCompliance.begin(), m_distanceCompliance.end(), _compliance);
+}
+
+void ConstraintStore::setBendingCompliance(float _compliance)
+{
+  std::fill(m_bendingCompliance.begin(), m_bendingCompliance.end(), _compliance);
+}
+
+void ConstraintStore::buildColourBatches()
+{
+  std::vector<std::size_t> order;
+  if (!m_distanceA.empty())
+  {
+    m_distanceColourOffsets = colourConstraints({&m_distanceA, &m_distanceB}, order);
+    reorder(m_distanceA, order);
+    reorder(m_distanceB, order);
+    reorder(m_distanceRestLength, order);
+    reorder(m_distanceCompliance, order);
+    reorder(m_distanceLambda, order);
+  }
+  if (!m_bendingA.empty())
+  {
+    m_bendingColourOffsets = colourConstraints({&m_bendingA, &m_bendingB, &m_bendingC}, order);
+    reorder(m_bendingA, order);
+    reorder(m_bendingB, order);
+    reorder(m_bendingC, order);
+    reorder(m_bendingRestLength, order);
+    reorder(m_bendingCompliance, order);
+    reorder(m_bendingLambda, order);
+  }
+}
+
+std::size_t ConstraintStore::getNumDistanceColours() const
+{
+  return m_distanceColourOffsets.empty() ? 0 : m_distanceColourOffsets.size() - 1;
+}
+
+std::size_t ConstraintStore::getDistanceColourBegin(std::size_t _colour) const
+{
+  return m_distanceColourOffsets[_colour];
+}
+
+std::size_t ConstraintStore::getDistanceColourEnd(std::size_t _colour) const
+{
+  return m_distanceColourOffsets[_colour + 1];
+}
+
+std::size_t ConstraintStore::getNumBendingColours() const
+{
+  return m_bendingColourOffsets.empty() ? 0 : m_bendingColourOffsets.size() - 1;
+}
+
+std::size_t ConstraintStore::getBendingColourBegin(std::size_t _colour) const
+{
+  return m_bendingColourOffsets[_colour];
+}
+
+std::size_t ConstraintStore::getBendingColourEnd(std::size_t _colour) const
+{
+  return m_bendingColourOffsets[_colour + 1];
+}
+
+void ConstraintStore::resetLambdas()
+{
+  std::fill(m_distanceLambda.begin(), m_distanceLambda.end(), 0.0f);
+  std::fill(m_pinLambda.begin(), m_pinLambda.end(), 0.0f);
+  std::fill(m_bendingLambda.begin(), m_bendingLambda.end(), 0.0f);
+}
+
+void ConstraintStore::solveDistances(ParticleStore &_particles, float _dt, std::size_t _begin, std::size_t _end)
+{
+  const float *invMass = _particles.getInvMass();
+  float invDtSquared = 1.0f / (_dt * _dt);
+
+  for (std::size_t i = _begin; i < _end; ++i)
+  {
+    std::uint32_t a = m_distanceA[i];
+    std::uint32_t b = m_distanceB[i];
+    float weight = invMass[a] + invMass[b];
+    glm::vec3 direction = _particles.getPos(b) - _particles.getPos(a);
+    float length = glm::length(direction);
+    if (length <= 0.0f || weight <= 0.0f)
+    {
+      continue;
+    }
+
+    //the change in the multiplier, the compliance is scaled by the step so the stiffness does not depend on dt
+    glm::vec3 normal = direction / length;
+    float compliance = m_distanceCompliance[i] * invDtSquared;
+    float constraint = length - m_distanceRestLength[i];
+    float deltaLambda = (-constraint - (compliance * m_distanceLambda[i])) / (weight + compliance);
+    m_distanceLambda[i] += deltaLambda;
+
+    //point a moves against the normal and point b along it
+    _particles.setPos(a, _particles.getPos(a) - (invMass[a] * deltaLambda * normal));
+    _particles.setPos(b, _particles.getPos(b) + (invMass[b] * deltaLambda * normal));
+  }
+}
+
+void ConstraintStore::solveBendings(ParticleStore &_particles, float _dt, std::size_t _begin, std::size_t _end)
+{
+  const float *invMass = _particles.getInvMass();
+  float invDtSquared = 1.0f / (_dt * _dt);
+
+  for (std::size_t i = _begin; i < _end; ++i)
+  {
+    std::uint32_t a = m_bendingA[i];
+    std::uint32_t b = m_bendingB[i];
+    std::uint32_t c = m_bendingC[i];
+
+    //the offset of the middle point from the centre of the three points
+    glm::vec3 centre = (_particles.getPos(a) + _particles.getPos(b) + _particles.getPos(c)) / 3.0f;
+    glm::vec3 offset = _particles.getPos(b) - centre;
+    float length = glm::length(offset);
+    if (length <= 1e-6f)
+    {
+      continue;
+    }
+
+    //the gradient is 2/3 of the normal for the middle point and -1/3 for the outer points
+    glm::vec3 normal = offset / length;
+    float weight = (invMass[a] + (4.0f * invMass[b]) + invMass[c]) / 9.0f;
+    if (weight <= 0.0f)
+    {
+      continue;
+    }
+    float compliance = m_bendingCompliance[i] * invDtSquared;
+    float constraint = length - m_bendingRestLength[i];
+    float deltaLambda = (-constraint - (compliance * m_bendingLambda[i])) / (weight + compliance);
+    m_bendingLambda[i] += deltaLambda;
+
+    _particles.setPos(a, _particles.getPos(a) - (invMass[a] * deltaLambda / 3.0f * normal));
+    _particles.setPos(b, _particles.getPos(b) + (invMass[b] * deltaLambda * 2.0f / 3.0f * normal));
+    _particles.setPos(c, _particles.getPos(c) - (invMass[c] * deltaLambda / 3.0f * normal));
+  }
+}
+
+void ConstraintStore::solvePins(ParticleStore &_particles, float _dt)
+{
+  const float *invMass = _particles.getInvMass();
+  float invDtSquared = 1.0f / (_dt * _dt);
+
+  for (std::size_t i = 0; i < m_pinPoint.size(); ++i)
+  {
+    std::uint32_t point = m_pinPoint[i];
+    glm::vec3 offset = _particles.getPos(point) - m_pinPosition[i];
+    float length = glm::length(offset);
+    if (length <= 0.0f)
+    {
+      continue;
+    }
+
+    //a rigid pin puts the point straight back
+    if (m_pinCompliance[i] <= 0.0f)
+    {
+      _particles.setPos(point, m_pinPosition[i]);
+      continue;
+    }
+
+    float compliance = m_pinCompliance[i] * invDtSquared;
+    float deltaLambda = (-length - (compliance * m_pinLambda[i])) / (invMass[point] + compliance);
+    m_pinLambda[i] += deltaLambda;
+    _particles.setPos(point, _particles.getPos(point) + (invMass[point] * deltaLambda / length * offset));
+  }
+}
@@ -0,0 +1,75 @@
+#include "FixedStepClock.h"
+#include <algorithm>
+#include <cmath>
+
+FixedStepClock::FixedStepClock() : m_accumulator(0.0f), m_stepSize(1.0f / 60.0f), m_maxSteps(5), m_numDroppedFrames(0)
+{
+}
+
+FixedStepClock::FixedStepClock(float _stepSize, unsigned int _maxSteps) : m_accumulator(0.0f), m_stepSize(_stepSize),
+  m_maxSteps(_maxSteps), m_numDroppedFrames(0)
+{
+}
+
+FixedStepClock::~FixedStepClock()
+{
+}
+
+unsigned int FixedStepClock::advance(float _frameTime)
+{
+  //a stalled timer can report a negative time
+  m_accumulator += std::max(_frameTime, 0.0f);
+
+  unsigned int numSteps = 0;
+  while (m_accumulator >= m_stepSize && numSteps < m_maxSteps)
+  {
+    m_accumulator -= m_stepSize;
+    ++numSteps;
+  }
+
+  //drop the time that could not be caught up with, keeping it would make every following frame hit the cap too
+  if (m_accumulator >= m_stepSize)
+  {
+    m_accumulator = std::fmod(m_accumulator, m_stepSize);
+    ++m_numDroppedFrames;
+  }
+
+  return numSteps;
+}
+
+float FixedStepClock::getAlpha() const
+{
+  return m_accumulator / m_stepSize;
+}
+
+void FixedStepClock::reset()
+{
+  m_accumulator = 0.0f;
+}
+
+float FixedStepClock::getStepSize() const
+{
+  return m_stepSize;
+}
+
+void FixedStepClock::setStepSize(float _stepSize)
+{
+  m_stepSize = _stepSize;
+  //keep the blend in range for the new step size
+  m_accumulator = std::min(m_accumulator, m_stepSize * 0.999f);
+}
+
+unsigned int FixedStepClock::getMaxSteps() const
+{
+  return m_maxSteps;
+}
+
+void FixedStepClock::setMaxSteps(unsigned int _maxSteps)
+{
+  m_maxSteps = _maxSteps;
+}
+
+unsigned int FixedStepClock::getNumDroppedFrames() const
+{
+  return m_numDroppedFrames;
+}
@@ -0,0 +1,308 @@
+#include "FlameBatch.h"
+#include "SimdKernels.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+
+FlameBatch::FlameBatch() : m_solverType(SolverType::EXPLICIT), m_integratorType(IntegratorType::SYMPLECTIC_EULER),
+  m_doublePrecision(false), m_blockedSubsteps(false), m_stepper(createStepper(IntegratorType::SYMPLECTIC_EULER, false))
+{
+}
+
+FlameBatch::~FlameBatch()
+{
+}
+
+void FlameBatch::build(const std::vector<std::shared_ptr<MassSpringObject>> &_flames)
+{
+  clear();
+  m_flames = _flames;
+
+  //work out the size of the shared buffers
+  std::size_t numParticles = 0;
+  for (auto flame : m_flames)
+  {
+    numParticles += flame->getParticles().size();
+  }
+  m_particles.reserve(numParticles);
+
+  //pack each flame after the one before it, with the points of its grid after those of the flame before it
+  std::vector<std::uint32_t> points;
+  points.reserve(numParticles);
+  for (auto flame : m_flames)
+  {
+    std::uint32_t offset = std::uint32_t(m_particles.size());
+    m_particleOffsets.push_back(m_particles.size());
+    m_particles.append(flame->getParticles());
+    for (auto point : flame->getOrdering().getPoints())
+    {
+      points.push_back(offset + point);
+    }
+  }
+  m_particleOffsets.push_back(m_particles.size());
+  m_xpbdSolver.setPoints(points);
+  m_externalForces.resize(m_flames.size());
+
+  if (!m_flames.empty())
+  {
+    //the grids of the flames are one after the other so one stencil covers them all
+    m_stencil = m_flames[0]->getStencil();
+    m_stencil.setGrid(m_stencil.getGridSize(), m_flames.size());
+  }
+
+  if (m_solverType != SolverType::GRID_STENCIL)
+  {
+    buildSprings();
+  }
+}
+
+void FlameBatch::clear()
+{
+  m_flames.clear();
+  m_particleOffsets.clear();
+  m_externalForces.clear();
+  m_particles.clear();
+  m_springs.clear();
+  m_implicitSolver.reset();
+  m_projectiveSolver.invalidate();
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
+}
+
+bool FlameBatch::isEmpty() const
+{
+  return m_flames.empty();
+}
+
+void FlameBatch::writeBack()
+{
+  for (std::size_t i = 0; i < m_flames.size(); ++i)
+  {
+    m_flames[i]->copyParticlesFrom(m_particles, m_particleOffsets[i]);
+  }
+}
+
+void FlameBatch::update(float _dt)
+{
+  TaskScheduler &scheduler = TaskScheduler::instance();
+
+  //each flame keeps its own wind impulse
+  for (std::size_t i = 0; i < m_flames.size(); ++i)
+  {
+    m_externalForces[i] = m_flames[i]->updateExternalForces(_dt);
+  }
+
+  //the solvers take one external force so each flame adds its own to the accumulators first
+  applyExternalForces();
+
+  //update the points of every flame in one pass
+  if (m_solverType == SolverType::IMPLICIT)
+  {
+    SimdKernels::computeSpringForcesParallel(m_springs, m_particles);
+    m_implicitSolver.integrate(m_springs, m_particles, glm::vec3(0.0f), _dt);
+  }
+  else if (m_solverType == SolverType::PROJECTIVE)
+  {
+    m_projectiveSolver.integrate(m_springs, m_particles, glm::vec3(0.0f), _dt);
+  }
+  else if (m_solverType == SolverType::XPBD)
+  {
+    m_xpbdSolver.integrate(m_springs, m_particles, glm::vec3(0.0f), _dt);
+  }
+  else if (m_solverType == SolverType::GRID_STENCIL)
+  {
+    unsigned int numSubsteps = m_stepController.computeNumSubsteps(m_stencil, m_particles, glm::vec3(0.0f), _dt);
+    float substep = _dt / float(numSubsteps);
+    if (m_blockedSubsteps && numSubsteps > 1)
+    {
+      //each flame is a grid of the stencil so the bands take the external force of their flame
+      m_stencil.stepBlocked(m_particles, m_externalForces, substep, numSubsteps);
+    }
+    else
+    {
+      for (unsigned int i = 0; i < numSubsteps; ++i)
+      {
+        if (i > 0)
+        {
+          applyExternalForces();
+        }
+        m_stencil.computeForcesParallel(m_particles);
+        SimdKernels::integrateParallel(m_particles, glm::vec3(0.0f), substep, 0, m_particles.size());
+      }
+    }
+  }
+  else
+  {
+    //only split the step when the springs or a gust would make it unstable, the stiffest flame sets the substeps
+    unsigned int numSubsteps = m_stepController.computeNumSubsteps(m_springs, m_particles, glm::vec3(0.0f), _dt);
+    float substep = _dt / float(numSubsteps);
+    for (unsigned int i = 0; i < numSubsteps; ++i)
+    {
+      //the stepper leaves the spring forces in the accumulators
+      if (i > 0)
+      {
+        applyExternalForces();
+      }
+      m_stepper->step(m_springs, m_particles, glm::vec3(0.0f), substep);
+    }
+  }
+
+  //update the vertices of the flames
+  scheduler.parallelFor(0, m_flames.size(), 16, [this](std::size_t _begin, std::size_t _end)
+  {
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      m_flames[i]->updateFromBatch(m_particles, m_particleOffsets[i]);
+    }
+  });
+}
+
+void FlameBatch::setMass(float _mass)
+{
+  m_particles.setMass(_mass);
+  m_projectiveSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
+}
+
+void FlameBatch::setSpringConstant(float _springConstant)
+{
+  copyMaterials();
+  m_stencil.setStiffness(_springConstant);
+  m_projectiveSolver.invalidate();
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  //the acceleration kept by the Verlet stepper was computed with the old springs
+  m_stepper->reset();
+}
+
+void FlameBatch::setDamping(float _damping)
+{
+  m_springs.setDamping(_damping);
+  m_stencil.setDamping(_damping);
+  m_stepper->reset();
+}
+
+void FlameBatch::setRestLength(float _restLength)
+{
+  copyMaterials();
+  m_stencil.setRestLength(_restLength);
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
+}
+
+void FlameBatch::setBaseStiffness(float _baseStiffness)
+{
+  m_stencil.setBaseStiffness(_baseStiffness, MassSpringObject::c_baseRows);
+  copyMaterials();
+  m_projectiveSolver.invalidate();
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
+}
+
+void FlameBatch::setSolverType(SolverType _solverType)
+{
+  m_solverType = _solverType;
+  if (_solverType == SolverType::GRID_STENCIL)
+  {
+    //the stencil needs no edge list so its memory is given back
+    m_springs = SpringStore();
+  }
+  else if (m_springs.size() == 0)
+  {
+    //the flames have built their springs again for the new solver
+    buildSprings();
+  }
+  m_implicitSolver.reset();
+  m_projectiveSolver.invalidate();
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
+}
+
+void FlameBatch::setIntegrator(IntegratorType _integratorType, bool _doublePrecision)
+{
+  m_integratorType = _integratorType;
+  m_doublePrecision = _doublePrecision;
+  m_stepper = createStepper(_integratorType, _doublePrecision);
+}
+
+void FlameBatch::setBlockedSubsteps(bool _blockedSubsteps)
+{
+  m_blockedSubsteps = _blockedSubsteps;
+}
+
+unsigned int FlameBatch::getNumSubsteps() const
+{
+  if (m_solverType != SolverType::EXPLICIT && m_solverType != SolverType::GRID_STENCIL)
+  {
+    return 1;
+  }
+  return m_stepController.getNumSubsteps();
+}
+
+const ParticleStore &FlameBatch::getParticles() const
+{
+  return m_particles;
+}
+
+std::size_t FlameBatch::getParticleOffset(std::size_t _flameIndex) const
+{
+  return m_particleOffsets[_flameIndex];
+}
+
+void FlameBatch::buildSprings()
+{
+  std::size_t numSprings = 0;
+  for (auto flame : m_flames)
+  {
+    numSprings += flame->getSprings().size();
+  }
+  m_springs.clear();
+  m_springs.reserve(numSprings);
+
+  for (std::size_t i = 0; i < m_flames.size(); ++i)
+  {
+    m_springs.append(m_flames[i]->getSprings(), std::uint32_t(m_particleOffsets[i]));
+  }
+
+  if (!m_flames.empty())
+  {
+    m_springs.setDamping(m_flames[0]->getSprings().getDamping());
+  }
+
+  //the flames share no points so the batch colours the same as one flame
+  m_springs.buildColourBatches();
+}
+
+void FlameBatch::applyExternalForces()
+{
+  m_particles.clearForces();
+  for (std::size_t i = 0; i < m_flames.size(); ++i)
+  {
+    for (std::size_t point = m_particleOffsets[i]; point < m_particleOffsets[i + 1]; ++point)
+    {
+      m_particles.addForce(point, m_externalForces[i]);
+    }
+  }
+}
+
+void FlameBatch::copyMaterials()
+{
+  if (m_flames.empty())
+  {
+    return;
+  }
+
+  //the flames share their materials in the batch so each is one entry for all of them, they are copied rather than
+  //scaled so a setting of zero is not kept
+  const SpringStore &springs = m_flames[0]->getSprings();
+  std::size_t numMaterials = std::min(springs.getNumMaterials(), m_springs.getNumMaterials());
+  for (std::size_t material = 0; material < numMaterials; ++material)
+  {
+    m_springs.setMaterialStiffness(std::uint8_t(material), springs.getMaterialStiffness(std::uint8_t(material)));
+    m_springs.setMaterialRestLength(std::uint8_t(material), springs.getMaterialRestLength(std::uint8_t(material)));
+  }
+}
@@ -0,0 +1,149 @@
+#include "FlameInstances.h"
+#include "glm/gtc/type_ptr.hpp"
+#include <cstring>
+
+FlameInstances::FlameInstances() : m_vao(0), m_positionBuffer(0), m_positionTexture(0), m_uvBuffer(0),
+  m_indexBuffer(0), m_instanceBuffer(0), m_meshVersion(0), m_numIndices(0), m_indexType(GL_UNSIGNED_SHORT),
+  m_numVertices(0), m_numInstances(0), m_maxTexels(0)
+{
+  glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &m_maxTexels);
+
+  glGenVertexArrays(1, &m_vao);
+  glGenBuffers(1, &m_positionBuffer);
+  glGenBuffers(1, &m_uvBuffer);
+  glGenBuffers(1, &m_indexBuffer);
+  glGenBuffers(1, &m_instanceBuffer);
+
+  //the positions are read as single floats, three texels a vertex, as three component texture buffers need GL 4.0
+  glGenTextures(1, &m_positionTexture);
+  glBindBuffer(GL_TEXTURE_BUFFER, m_positionBuffer);
+  glBindTexture(GL_TEXTURE_BUFFER, m_positionTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, m_positionBuffer);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+  glBindVertexArray(m_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, m_uvBuffer);
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, nullptr);
+  glEnableVertexAttribArray(2);
+
+  //the transform takes the four attributes from 3 as columns and the texture layer is attribute 7, all step once an
+  //instance
+  glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+  GLsizei stride = GLsizei(sizeof(float) * c_instanceSize);
+  for (GLuint i = 0; i < 5; ++i)
+  {
+    GLint size = (i < 4) ? 4 : 1;
+    glVertexAttribPointer(3 + i, size, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void *>(sizeof(float) * 4 * i));
+    glVertexAttribDivisor(3 + i, 1);
+    glEnableVertexAttribArray(3 + i);
+  }
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+FlameInstances::~FlameInstances()
+{
+  glDeleteTextures(1, &m_positionTexture);
+  glDeleteBuffers(1, &m_instanceBuffer);
+  glDeleteBuffers(1, &m_indexBuffer);
+  glDeleteBuffers(1, &m_uvBuffer);
+  glDeleteBuffers(1, &m_positionBuffer);
+  glDeleteVertexArrays(1, &m_vao);
+}
+
+bool FlameInstances::update(const FrameSnapshot &_snapshot, bool _positionsChanged, int _solidLayer)
+{
+  if (_snapshot.m_flames.empty())
+  {
+    m_numInstances = 0;
+    return true;
+  }
+
+  //every flame has to have the same mesh as the first for them to share its indices
+  const FlameSnapshot &first = _snapshot.m_flames[0];
+  for (const FlameSnapshot &flame : _snapshot.m_flames)
+  {
+    if (flame.m_positions.size() != first.m_positions.size() || flame.m_indices.size() != first.m_indices.size())
+    {
+      return false;
+    }
+  }
+  std::size_t flameSize = first.m_positions.size();
+  if (flameSize * _snapshot.m_flames.size() > std::size_t(m_maxTexels))
+  {
+    return false;
+  }
+
+  glBindVertexArray(m_vao);
+
+  //the shared uv's and indices only change when the flames are generated again
+  bool meshChanged = (m_meshVersion != first.m_meshVersion);
+  if (meshChanged)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER, m_uvBuffer);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(first.m_uvs.size() * sizeof(glm::vec2)), first.m_uvs.data(),
+                 GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(first.m_indices.size() * first.m_indices.getIndexSize()),
+                 first.m_indices.getData(), GL_STATIC_DRAW);
+    m_numIndices = GLsizei(first.m_indices.size());
+    m_indexType = first.m_indices.getIsInt() ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+    m_numVertices = GLint(flameSize / 3);
+    m_meshVersion = first.m_meshVersion;
+  }
+
+  GLsizei numInstances = GLsizei(_snapshot.m_flames.size());
+  if (_positionsChanged || meshChanged || numInstances != m_numInstances)
+  {
+    //orphan the old positions then copy each flame into its place, instance i starts at i * numVertices
+    glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(flameSize * _snapshot.m_flames.size() * sizeof(float)), nullptr,
+                 GL_STREAM_DRAW);
+    for (std::size_t i = 0; i < _snapshot.m_flames.size(); ++i)
+    {
+      glBufferSubData(GL_ARRAY_BUFFER, GLintptr(i * flameSize * sizeof(float)), GLsizeiptr(flameSize * sizeof(float)),
+                      _snapshot.m_flames[i].m_positions.data());
+    }
+  }
+  m_numInstances = numInstances;
+
+  //the instance data is small so it is packed every frame, the texture changes without a new snapshot
+  m_instanceData.resize(_snapshot.m_flames.size() * c_instanceSize);
+  for (std::size_t i = 0; i < _snapshot.m_flames.size(); ++i)
+  {
+    const FlameSnapshot &flame = _snapshot.m_flames[i];
+    float *instance = &m_instanceData[i * c_instanceSize];
+    std::memcpy(instance, glm::value_ptr(flame.m_transform), sizeof(float) * 16);
+    instance[16] = float((_solidLayer < 0) ? flame.m_textureNum : _solidLayer);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+  glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(m_instanceData.size() * sizeof(float)), nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(m_instanceData.size() * sizeof(float)), m_instanceData.data());
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return true;
+}
+
+void FlameInstances::draw() const
+{
+  if (m_numInstances == 0)
+  {
+    return;
+  }
+
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_BUFFER, m_positionTexture);
+  glActiveTexture(GL_TEXTURE0);
+
+  glBindVertexArray(m_vao);
+  glDrawElementsInstanced(GL_TRIANGLES, m_numIndices, m_indexType, nullptr, m_numInstances);
+  glBindVertexArray(0);
+}
+
+GLint FlameInstances::getNumVertices() const
+{
+  return m_numVertices;
+}
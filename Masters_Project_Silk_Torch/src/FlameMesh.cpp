@@ -0,0 +1,69 @@
+#include "FlameMesh.h"
+
+FlameMesh::FlameMesh() : m_vao(0), m_positionBuffer(0), m_uvBuffer(0), m_indexBuffer(0), m_meshVersion(0),
+  m_numIndices(0), m_indexType(GL_UNSIGNED_SHORT)
+{
+  glGenVertexArrays(1, &m_vao);
+  glGenBuffers(1, &m_positionBuffer);
+  glGenBuffers(1, &m_uvBuffer);
+  glGenBuffers(1, &m_indexBuffer);
+
+  //the layout of the buffers never changes so it is only set once
+  glBindVertexArray(m_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, nullptr);
+  glEnableVertexAttribArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, m_uvBuffer);
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, nullptr);
+  glEnableVertexAttribArray(2);
+  //the element buffer is part of the state of the vertex array
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+FlameMesh::~FlameMesh()
+{
+  glDeleteBuffers(1, &m_indexBuffer);
+  glDeleteBuffers(1, &m_uvBuffer);
+  glDeleteBuffers(1, &m_positionBuffer);
+  glDeleteVertexArrays(1, &m_vao);
+}
+
+void FlameMesh::update(const FlameSnapshot &_flame, bool _positionsChanged)
+{
+  glBindVertexArray(m_vao);
+
+  //the static streams are only uploaded when the flame has been generated again
+  bool meshChanged = (m_meshVersion != _flame.m_meshVersion);
+  if (meshChanged)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER, m_uvBuffer);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(_flame.m_uvs.size() * sizeof(glm::vec2)), _flame.m_uvs.data(),
+                 GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(_flame.m_indices.size() * _flame.m_indices.getIndexSize()),
+                 _flame.m_indices.getData(), GL_STATIC_DRAW);
+    m_numIndices = GLsizei(_flame.m_indices.size());
+    m_indexType = _flame.m_indices.getIsInt() ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+    m_meshVersion = _flame.m_meshVersion;
+  }
+
+  if (_positionsChanged || meshChanged)
+  {
+    //orphan the old positions so the upload does not wait for the frame still drawing from them
+    GLsizeiptr size = GLsizeiptr(_flame.m_positions.size() * sizeof(float));
+    glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
+    glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, _flame.m_positions.data());
+  }
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void FlameMesh::draw() const
+{
+  glBindVertexArray(m_vao);
+  glDrawElements(GL_TRIANGLES, m_numIndices, m_indexType, nullptr);
+  glBindVertexArray(0);
+}
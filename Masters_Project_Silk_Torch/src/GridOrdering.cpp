@@ -0,0 +1,115 @@
+#include "GridOrdering.h"
+#include <algorithm>
+
+GridOrdering::GridOrdering() : m_gridSize(0), m_order(ParticleOrder::ROW_MAJOR)
+{
+}
+
+GridOrdering::~GridOrdering()
+{
+}
+
+void GridOrdering::build(unsigned int _gridSize, ParticleOrder _order)
+{
+  m_gridSize = _gridSize;
+  m_order = _order;
+  std::size_t numPoints = std::size_t(_gridSize) * _gridSize;
+  m_indices.assign(numPoints, 0);
+  m_points.clear();
+  m_points.reserve(numPoints);
+
+  switch (_order)
+  {
+    case ParticleOrder::ROW_MAJOR:
+      for (unsigned int y = 0; y < _gridSize; ++y)
+      {
+        for (unsigned int x = 0; x < _gridSize; ++x)
+        {
+          addPoint(x, y);
+        }
+      }
+      break;
+    case ParticleOrder::TILED:
+      //the tiles are stored row by row, the tiles along the top and right are cut short when the grid does not fit
+      for (unsigned int tileY = 0; tileY < _gridSize; tileY += c_tileSize)
+      {
+        for (unsigned int tileX = 0; tileX < _gridSize; tileX += c_tileSize)
+        {
+          unsigned int endY = std::min(tileY + c_tileSize, _gridSize);
+          unsigned int endX = std::min(tileX + c_tileSize, _gridSize);
+          for (unsigned int y = tileY; y < endY; ++y)
+          {
+            for (unsigned int x = tileX; x < endX; ++x)
+            {
+              addPoint(x, y);
+            }
+          }
+        }
+      }
+      break;
+    case ParticleOrder::MORTON:
+    {
+      //sorting by the interleaved bits of x and y follows the Z-order curve, the points outside the grid are skipped
+      std::vector<std::uint64_t> codes;
+      codes.reserve(numPoints);
+      for (unsigned int y = 0; y < _gridSize; ++y)
+      {
+        for (unsigned int x = 0; x < _gridSize; ++x)
+        {
+          codes.push_back(spreadBits(x) | (spreadBits(y) << 1));
+        }
+      }
+      std::sort(codes.begin(), codes.end());
+      for (auto code : codes)
+      {
+        unsigned int x = 0;
+        unsigned int y = 0;
+        for (unsigned int bit = 0; bit < 32; ++bit)
+        {
+          x |= unsigned((code >> (2 * bit)) & 1) << bit;
+          y |= unsigned((code >> ((2 * bit) + 1)) & 1) << bit;
+        }
+        addPoint(x, y);
+      }
+      break;
+    }
+  }
+}
+
+ParticleOrder GridOrdering::getOrder() const
+{
+  return m_order;
+}
+
+std::uint32_t GridOrdering::getIndex(unsigned int _x, unsigned int _y) const
+{
+  return m_indices[(std::size_t(_y) * m_gridSize) + _x];
+}
+
+std::uint32_t GridOrdering::getPoint(std::size_t _index) const
+{
+  return m_points[_index];
+}
+
+const std::vector<std::uint32_t> &GridOrdering::getPoints() const
+{
+  return m_points;
+}
+
+void GridOrdering::addPoint(unsigned int _x, unsigned int _y)
+{
+  std::size_t point = (std::size_t(_y) * m_gridSize) + _x;
+  m_indices[point] = std::uint32_t(m_points.size());
+  m_points.push_back(std::uint32_t(point));
+}
+
+std::uint64_t GridOrdering::spreadBits(std::uint32_t _value)
+{
+  std::uint64_t spread = _value;
+  spread = (spread | (spread << 16)) & 0x0000ffff0000ffffull;
+  spread = (spread | (spread << 8)) & 0x00ff00ff00ff00ffull;
+  spread = (spread | (spread << 4)) & 0x0f0f0f0f0f0f0f0full;
+  spread = (spread | (spread << 2)) & 0x3333333333333333ull;
+  spread = (spread | (spread << 1)) & 0x5555555555555555ull;
+  return spread;
+}
@@ -0,0 +1,307 @@
+#include "GridStencil.h"
+#include "SimdKernels.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  ///The band of rows each thread is stepping, kept between steps so its memory is reused.
+  thread_local ParticleStore t_band;
+}
+
+GridStencil::GridStencil() : m_gridSize(0), m_numGrids(0), m_stiffness(100.0f), m_baseStiffness(1.0f), m_baseRows(0),
+  m_restLength(1.0f), m_damping(0.1f), m_shear(false), m_bend(false), m_tileSize(c_defaultTileSize)
+{
+}
+
+GridStencil::~GridStencil()
+{
+}
+
+void GridStencil::setGrid(unsigned int _gridSize, std::size_t _numGrids)
+{
+  m_gridSize = _gridSize;
+  m_numGrids = _numGrids;
+}
+
+unsigned int GridStencil::getGridSize() const
+{
+  return m_gridSize;
+}
+
+std::size_t GridStencil::getNumGrids() const
+{
+  return m_numGrids;
+}
+
+void GridStencil::setStiffness(float _stiffness)
+{
+  m_stiffness = _stiffness;
+}
+
+float GridStencil::getStiffness() const
+{
+  return m_stiffness;
+}
+
+void GridStencil::setBaseStiffness(float _baseStiffness, unsigned int _baseRows)
+{
+  m_baseStiffness = _baseStiffness;
+  m_baseRows = _baseRows;
+}
+
+void GridStencil::setRestLength(float _restLength)
+{
+  m_restLength = _restLength;
+}
+
+float GridStencil::getRestLength() const
+{
+  return m_restLength;
+}
+
+void GridStencil::setDamping(float _damping)
+{
+  m_damping = _damping;
+}
+
+void GridStencil::setSprings(bool _shear, bool _bend)
+{
+  m_shear = _shear;
+  m_bend = _bend;
+}
+
+void GridStencil::computeForces(ParticleStore &_particles) const
+{
+  computeForces(_particles, 0, m_numGrids * m_gridSize);
+}
+
+void GridStencil::computeForces(ParticleStore &_particles, std::size_t _beginRow, std::size_t _endRow) const
+{
+  computeRows(_particles, 0, _beginRow, _endRow);
+}
+
+void GridStencil::computeRows(ParticleStore &_particles, std::size_t _firstRow, std::size_t _beginRow,
+                              std::size_t _endRow) const
+{
+  float shearLength = m_restLength * std::sqrt(2.0f);
+  float bendLength = m_restLength * 2.0f;
+  for (std::size_t row = _beginRow; row < _endRow; ++row)
+  {
+    std::size_t first = (row - _firstRow) * m_gridSize;
+    unsigned int y = unsigned(row % m_gridSize);
+
+    //the structural springs
+    addNeighbours(_particles, first, y, -1, 0, m_restLength);
+    addNeighbours(_particles, first, y, 1, 0, m_restLength);
+    addNeighbours(_particles, first, y, 0, -1, m_restLength);
+    addNeighbours(_particles, first, y, 0, 1, m_restLength);
+
+    if (m_shear)
+    {
+      addNeighbours(_particles, first, y, -1, -1, shearLength);
+      addNeighbours(_particles, first, y, 1, -1, shearLength);
+      addNeighbours(_particles, first, y, -1, 1, shearLength);
+      addNeighbours(_particles, first, y, 1, 1, shearLength);
+    }
+
+    if (m_bend)
+    {
+      addNeighbours(_particles, first, y, -2, 0, bendLength);
+      addNeighbours(_particles, first, y, 2, 0, bendLength);
+      addNeighbours(_particles, first, y, 0, -2, bendLength);
+      addNeighbours(_particles, first, y, 0, 2, bendLength);
+    }
+  }
+}
+
+void GridStencil::computeForcesParallel(ParticleStore &_particles) const
+{
+  std::size_t numRows = m_numGrids * m_gridSize;
+  if (_particles.size() < SimdKernels::c_parallelThreshold || m_gridSize == 0)
+  {
+    computeForces(_particles, 0, numRows);
+    return;
+  }
+
+  //every row only writes its own particles so the rows need no batches
+  std::size_t grainSize = std::max<std::size_t>(1, SimdKernels::c_parallelGrainSize / m_gridSize);
+  TaskScheduler::instance().parallelFor(0, numRows, grainSize, [this, &_particles](std::size_t _chunkBegin, std::size_t _chunkEnd)
+  {
+    computeForces(_particles, _chunkBegin, _chunkEnd);
+  });
+}
+
+void GridStencil::stepBlocked(ParticleStore &_particles, const std::vector<glm::vec3> &_externalForces, float _dt,
+                              unsigned int _numSubsteps)
+{
+  std::size_t numRows = m_numGrids * m_gridSize;
+  if (numRows == 0)
+  {
+    return;
+  }
+  if (m_blockedState.size() != _particles.size())
+  {
+    m_blockedState.assign(_particles, 0, _particles.size());
+  }
+
+  TaskScheduler &scheduler = TaskScheduler::instance();
+  unsigned int radius = m_bend ? 2 : 1;
+  for (unsigned int done = 0; done < _numSubsteps; done += c_maxBlockedSubsteps)
+  {
+    unsigned int numSubsteps = _numSubsteps - done;
+    if (numSubsteps > c_maxBlockedSubsteps)
+    {
+      numSubsteps = c_maxBlockedSubsteps;
+    }
+
+    //the bands are kept at least four times as tall as the rows copied around them so little work is repeated
+    std::size_t bandRows = std::max<std::size_t>(m_tileSize / m_gridSize, 8 * numSubsteps * radius);
+    std::size_t numBands = (numRows + bandRows - 1) / bandRows;
+
+    //every band reads the particles as they were before the substeps and writes its own rows of the blocked state
+    scheduler.parallelFor(0, numBands, 1, [this, &_particles, &_externalForces, _dt, numSubsteps, numRows, bandRows](
+                          std::size_t _bandBegin, std::size_t _bandEnd)
+    {
+      for (std::size_t band = _bandBegin; band < _bandEnd; ++band)
+      {
+        stepBand(_particles, _externalForces, _dt, numSubsteps, band * bandRows, std::min(numRows, (band + 1) * bandRows));
+      }
+    });
+
+    //the blocked state now holds every row so it becomes the state of the particles
+    _particles.swapState(m_blockedState);
+  }
+}
+
+void GridStencil::setTileSize(std::size_t _tileSize)
+{
+  m_tileSize = _tileSize;
+}
+
+void GridStencil::stepBand(const ParticleStore &_particles, const std::vector<glm::vec3> &_externalForces, float _dt,
+                           unsigned int _numSubsteps, std::size_t _beginRow, std::size_t _endRow)
+{
+  //each substep reaches the radius of the stencil further, so that many rows are copied around the band
+  std::size_t numRows = m_numGrids * m_gridSize;
+  std::size_t radius = m_bend ? 2 : 1;
+  std::size_t halo = _numSubsteps * radius;
+  std::size_t firstRow = (_beginRow > halo) ? _beginRow - halo : 0;
+  std::size_t lastRow = std::min(numRows, _endRow + halo);
+  t_band.assign(_particles, firstRow * m_gridSize, (lastRow - firstRow) * m_gridSize);
+
+  for (unsigned int substep = 1; substep <= _numSubsteps; ++substep)
+  {
+    //the rows next to a cut edge of the band lose a neighbour each substep so fewer rows are right, the edges of the
+    //grids have no neighbours to lose
+    std::size_t beginRow = (firstRow == 0) ? 0 : firstRow + (substep * radius);
+    std::size_t endRow = (lastRow == numRows) ? numRows : lastRow - (substep * radius);
+
+    t_band.clearForces();
+    computeRows(t_band, firstRow, beginRow, endRow);
+
+    //the rows of each grid are integrated with the external force of their grid
+    for (std::size_t grid = beginRow / m_gridSize; grid * m_gridSize < endRow; ++grid)
+    {
+      std::size_t gridBegin = std::max(beginRow, grid * m_gridSize);
+      std::size_t gridEnd = std::min(endRow, (grid + 1) * m_gridSize);
+      SimdKernels::integrate(t_band, _externalForces[grid], _dt, (gridBegin - firstRow) * m_gridSize,
+                             (gridEnd - firstRow) * m_gridSize);
+    }
+  }
+
+  m_blockedState.copyState(t_band, (_beginRow - firstRow) * m_gridSize, (_endRow - _beginRow) * m_gridSize,
+                           _beginRow * m_gridSize);
+}
+
+void GridStencil::computeStiffnessSums(std::vector<float> &_stiffness) const
+{
+  _stiffness.assign(m_numGrids * m_gridSize * m_gridSize, 0.0f);
+
+  //the offsets of every neighbour a particle can have
+  std::vector<int> offsets = {-1, 0, 1, 0, 0, -1, 0, 1};
+  if (m_shear)
+  {
+    offsets.insert(offsets.end(), {-1, -1, 1, -1, -1, 1, 1, 1});
+  }
+  if (m_bend)
+  {
+    offsets.insert(offsets.end(), {-2, 0, 2, 0, 0, -2, 0, 2});
+  }
+
+  int gridSize = int(m_gridSize);
+  for (std::size_t i = 0; i < _stiffness.size(); ++i)
+  {
+    int x = int(i % m_gridSize);
+    int y = int((i / m_gridSize) % m_gridSize);
+    for (std::size_t j = 0; j < offsets.size(); j += 2)
+    {
+      int otherX = x + offsets[j];
+      int otherY = y + offsets[j + 1];
+      if (otherX >= 0 && otherX < gridSize && otherY >= 0 && otherY < gridSize)
+      {
+        _stiffness[i] += getStiffness(unsigned(y), unsigned(otherY));
+      }
+    }
+  }
+}
+
+float GridStencil::getMinRestLength() const
+{
+  return m_restLength;
+}
+
+void GridStencil::addNeighbours(ParticleStore &_particles, std::size_t _row, unsigned int _y, int _offsetX, int _offsetY,
+                                float _restLength) const
+{
+  //skip the rows that have no neighbour in this direction
+  int gridSize = int(m_gridSize);
+  int otherY = int(_y) + _offsetY;
+  if (otherY < 0 || otherY >= gridSize)
+  {
+    return;
+  }
+
+  const float *posX = _particles.getPosX();
+  const float *posY = _particles.getPosY();
+  const float *posZ = _particles.getPosZ();
+  const float *velX = _particles.getVelX();
+  const float *velY = _particles.getVelY();
+  const float *velZ = _particles.getVelZ();
+  float *forceX = _particles.getForceX();
+  float *forceY = _particles.getForceY();
+  float *forceZ = _particles.getForceZ();
+
+  //the particles along the row that have a neighbour, the neighbour is a fixed distance away in the arrays
+  std::size_t begin = _row + std::size_t(std::max(0, -_offsetX));
+  std::size_t end = _row + std::size_t(std::min(gridSize, gridSize - _offsetX));
+  std::ptrdiff_t offset = _offsetX + (_offsetY * gridSize);
+  float stiffness = getStiffness(_y, unsigned(otherY));
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    std::size_t other = std::size_t(std::ptrdiff_t(i) + offset);
+
+    //the vector to the neighbour
+    float dx = posX[other] - posX[i];
+    float dy = posY[other] - posY[i];
+    float dz = posZ[other] - posZ[i];
+
+    //the same force as SpringStore::computeForces, pulling towards the neighbour when stretched
+    float springLength = std::sqrt((dx * dx) + (dy * dy) + (dz * dz));
+    float springForceScale = (stiffness * (springLength - _restLength)) / springLength;
+    forceX[i] += (dx * springForceScale) - (m_damping * velX[i]);
+    forceY[i] += (dy * springForceScale) - (m_damping * velY[i]);
+    forceZ[i] += (dz * springForceScale) - (m_damping * velZ[i]);
+  }
+}
+
+float GridStencil::getStiffness(unsigned int _y, unsigned int _otherY) const
+{
+  //a spring is in the base when both ends are
+  if (std::max(_y, _otherY) < m_baseRows)
+  {
+    return m_stiffness * m_baseStiffness;
+  }
+  return m_stiffness;
+}
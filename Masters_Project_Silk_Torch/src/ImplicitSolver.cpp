@@ -0,0 +1,256 @@
+#include "ImplicitSolver.h"
+#include "SimdKernels.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  /**
+  @brief Sets the values of the locked particles to zero so they are left out of the solve.
+  @param[in] _particles The particles.
+  @param[in,out] _x The vector to filter, one value per particle.
+  */
+  void filterLocked(const ParticleStore &_particles, std::vector<glm::vec3> &_x)
+  {
+    const std::uint8_t *locked = _particles.getLocked();
+    for (std::size_t i = 0; i < _x.size(); ++i)
+    {
+      if (locked[i])
+      {
+        _x[i] = glm::vec3(0.0f);
+      }
+    }
+  }
+
+  /**
+  @brief Calculates the dot product of two vectors of per particle values.
+  @param[in] _a The first vector.
+  @param[in] _b The second vector.
+  @returns The dot product.
+  */
+  double dot(const std::vector<glm::vec3> &_a, const std::vector<glm::vec3> &_b)
+  {
+    double result = 0.0;
+    for (std::size_t i = 0; i < _a.size(); ++i)
+    {
+      result += double(glm::dot(_a[i], _b[i]));
+    }
+    return result;
+  }
+}
+
+ImplicitSolver::ImplicitSolver() : m_maxIterations(50), m_tolerance(1e-4f), m_lastIterations(0)
+{
+}
+
+ImplicitSolver::~ImplicitSolver()
+{
+}
+
+void ImplicitSolver::integrate(const SpringStore &_springs, ParticleStore &_particles, glm::vec3 _externalForce, float _dt)
+{
+  std::size_t numParticles = _particles.size();
+
+  //the warm start is only valid for the same particles
+  if (m_deltaVel.size() != numParticles)
+  {
+    m_deltaVel.assign(numParticles, glm::vec3(0.0f));
+  }
+  m_rhs.resize(numParticles);
+  m_residual.resize(numParticles);
+  m_preconditioned.resize(numParticles);
+  m_direction.resize(numParticles);
+  m_product.resize(numParticles);
+
+  assemble(_springs, _particles, _dt);
+
+  //the right hand side is dt * (f + dt * dF/dx * v)
+  for (std::size_t i = 0; i < numParticles; ++i)
+  {
+    m_direction[i] = _particles.getVel(i);
+  }
+  multiplyStiffness(_springs, m_direction, m_product);
+  for (std::size_t i = 0; i < numParticles; ++i)
+  {
+    m_rhs[i] = _dt * (_particles.getForce(i) + _externalForce + (_dt * m_product[i]));
+  }
+  filterLocked(_particles, m_rhs);
+  filterLocked(_particles, m_deltaVel);
+
+  //the residual of the warm start
+  multiplySystem(_springs, _particles, _dt, m_deltaVel, m_product);
+  for (std::size_t i = 0; i < numParticles; ++i)
+  {
+    m_residual[i] = m_rhs[i] - m_product[i];
+    m_preconditioned[i] = m_preconditioner[i] * m_residual[i];
+    m_direction[i] = m_preconditioned[i];
+    m_product[i] = m_preconditioner[i] * m_rhs[i];
+  }
+
+  //stop once the residual is small compared to the right hand side
+  double target = double(m_tolerance) * double(m_tolerance) * dot(m_rhs, m_product);
+  double residualDot = dot(m_residual, m_preconditioned);
+
+  m_lastIterations = 0;
+  while (m_lastIterations < m_maxIterations && residualDot > target)
+  {
+    multiplySystem(_springs, _particles, _dt, m_direction, m_product);
+    double directionDot = dot(m_direction, m_product);
+    if (directionDot <= 0.0)
+    {
+      break;
+    }
+
+    float alpha = float(residualDot / directionDot);
+    for (std::size_t i = 0; i < numParticles; ++i)
+    {
+      m_deltaVel[i] += alpha * m_direction[i];
+      m_residual[i] -= alpha * m_product[i];
+      m_preconditioned[i] = m_preconditioner[i] * m_residual[i];
+    }
+
+    double newResidualDot = dot(m_residual, m_preconditioned);
+    float beta = float(newResidualDot / residualDot);
+    residualDot = newResidualDot;
+    for (std::size_t i = 0; i < numParticles; ++i)
+    {
+      m_direction[i] = m_preconditioned[i] + (beta * m_direction[i]);
+    }
+    ++m_lastIterations;
+  }
+
+  //update the velocity and then the position of the unlocked particles
+  const std::uint8_t *locked = _particles.getLocked();
+  for (std::size_t i = 0; i < numParticles; ++i)
+  {
+    if (locked[i])
+    {
+      continue;
+    }
+    glm::vec3 vel = _particles.getVel(i) + m_deltaVel[i];
+    _particles.setVel(i, vel);
+    _particles.setPos(i, _particles.getPos(i) + (vel * _dt));
+  }
+}
+
+void ImplicitSolver::reset()
+{
+  m_deltaVel.clear();
+}
+
+void ImplicitSolver::setMaxIterations(unsigned int _maxIterations)
+{
+  m_maxIterations = _maxIterations;
+}
+
+unsigned int ImplicitSolver::getMaxIterations() const
+{
+  return m_maxIterations;
+}
+
+void ImplicitSolver::setTolerance(float _tolerance)
+{
+  m_tolerance = _tolerance;
+}
+
+float ImplicitSolver::getTolerance() const
+{
+  return m_tolerance;
+}
+
+unsigned int ImplicitSolver::getLastIterations() const
+{
+  return m_lastIterations;
+}
+
+void ImplicitSolver::assemble(const SpringStore &_springs, const ParticleStore &_particles, float _dt)
+{
+  std::size_t numParticles = _particles.size();
+  const float *invMass = _particles.getInvMass();
+
+  m_jacobians.resize(_springs.size());
+  m_dampingJacobian.assign(numParticles, 0.0f);
+  m_preconditioner.resize(numParticles);
+  std::vector<glm::vec3> stiffnessDiagonal(numParticles, glm::vec3(0.0f));
+
+  for (std::size_t i = 0; i < _springs.size(); ++i)
+  {
+    std::uint32_t a = _springs.getPointA(i);
+    std::uint32_t b = _springs.getPointB(i);
+
+    //the vector from point a to point b
+    glm::vec3 direction = _particles.getPos(b) - _particles.getPos(a);
+    float springLength = glm::length(direction);
+    glm::mat3 jacobian(0.0f);
+    if (springLength > 0.0f)
+    {
+      //the transverse part is clamped so compressed springs do not make the system indefinite
+      glm::vec3 normal = direction / springLength;
+      glm::mat3 outer = glm::outerProduct(normal, normal);
+      float transverse = std::max(0.0f, 1.0f - (_springs.getRestLength(i) / springLength));
+      jacobian = -_springs.getStiffness(i) * ((transverse * (glm::mat3(1.0f) - outer)) + outer);
+    }
+    m_jacobians[i] = jacobian;
+
+    //each spring damps both of its points
+    m_dampingJacobian[a] -= _springs.getDamping();
+    m_dampingJacobian[b] -= _springs.getDamping();
+
+    glm::vec3 diagonal(jacobian[0][0], jacobian[1][1], jacobian[2][2]);
+    stiffnessDiagonal[a] += diagonal;
+    stiffnessDiagonal[b] += diagonal;
+  }
+
+  //the diagonal of M - dt * dF/dv - dt^2 * dF/dx
+  for (std::size_t i = 0; i < numParticles; ++i)
+  {
+    glm::vec3 diagonal = glm::vec3((1.0f / invMass[i]) - (_dt * m_dampingJacobian[i])) - (_dt * _dt * stiffnessDiagonal[i]);
+    m_preconditioner[i] = 1.0f / diagonal;
+  }
+}
+
+void ImplicitSolver::multiplyStiffness(const SpringStore &_springs, const std::vector<glm::vec3> &_x, std::vector<glm::vec3> &_result) const
+{
+  std::fill(_result.begin(), _result.end(), glm::vec3(0.0f));
+
+  auto multiplyRange = [this, &_springs, &_x, &_result](std::size_t _begin, std::size_t _end)
+  {
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      std::uint32_t a = _springs.getPointA(i);
+      std::uint32_t b = _springs.getPointB(i);
+
+      //point b takes the product as + and point a as -
+      glm::vec3 product = m_jacobians[i] * (_x[b] - _x[a]);
+      _result[a] -= product;
+      _result[b] += product;
+    }
+  };
+
+  if (_springs.size() < SimdKernels::c_parallelThreshold || _springs.getNumColours() == 0)
+  {
+    multiplyRange(0, _springs.size());
+    return;
+  }
+
+  //no two springs in a colour batch share a particle so the batches can be split across the threads
+  for (std::size_t colour = 0; colour < _springs.getNumColours(); ++colour)
+  {
+    TaskScheduler::instance().parallelFor(_springs.getColourBegin(colour), _springs.getColourEnd(colour),
+                                          SimdKernels::c_parallelGrainSize, multiplyRange);
+  }
+}
+
+void ImplicitSolver::multiplySystem(const SpringStore &_springs, const ParticleStore &_particles, float _dt,
+                                    const std::vector<glm::vec3> &_x, std::vector<glm::vec3> &_result) const
+{
+  multiplyStiffness(_springs, _x, _result);
+
+  const float *invMass = _particles.getInvMass();
+  for (std::size_t i = 0; i < _x.size(); ++i)
+  {
+    _result[i] = (((1.0f / invMass[i]) - (_dt * m_dampingJacobian[i])) * _x[i]) - (_dt * _dt * _result[i]);
+  }
+  filterLocked(_particles, _result);
+}
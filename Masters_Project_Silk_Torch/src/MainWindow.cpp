@@ -10,9 +10,11 @@ MainWindow::MainWindow(QWidget *parent) :QMainWindow(parent), m_ui(new Ui::MainW
   m_ui->s_mainWindowGridLayout->addWidget(m_gl,0,0,5,1);
   connect(m_ui->m_wireframe,SIGNAL(toggled(bool)),m_gl,SLOT(toggleWireframe(bool)));
   connect(m_ui->m_textured,SIGNAL(toggled(bool)),m_gl,SLOT(toggleTextured(bool)));
+  connect(m_ui->m_instanced,SIGNAL(toggled(bool)),m_gl,SLOT(toggleInstanced(bool)));
   connect(m_ui->m_runProject,SIGNAL(clicked()),m_gl,SLOT(runProject()));
   connect(m_ui->m_restartProject,SIGNAL(clicked()),m_gl,SLOT(restartProject()));
   connect(m_ui->m_numOfObjects,SIGNAL(currentIndexChanged(int)),m_gl,SLOT(setNumOfObject(int)));
+  connect(m_ui->m_gridSize,SIGNAL(valueChanged(int)),m_gl,SLOT(setGridSize(int)));
   //set external forces
   connect(m_ui->m_buoyancy,SIGNAL(valueChanged(double)),m_gl,SLOT(setBuoyancy(double)));
   connect(m_ui->m_windImpulseOn,SIGNAL(valueChanged(double)),m_gl,SLOT(setWindImpulseOn(double)));
@@ -25,6 +27,16 @@ MainWindow::MainWindow(QWidget *parent) :QMainWindow(parent), m_ui(new Ui::MainW
   connect(m_ui->m_springConstant,SIGNAL(valueChanged(double)),m_gl,SLOT(setSpringConstant(double)));
   connect(m_ui->m_damping,SIGNAL(valueChanged(double)),m_gl,SLOT(setDamping(double)));
   connect(m_ui->m_restLength,SIGNAL(valueChanged(double)),m_gl,SLOT(setRestLength(double)));
+  connect(m_ui->m_baseStiffness,SIGNAL(valueChanged(double)),m_gl,SLOT(setBaseStiffness(double)));
+  connect(m_ui->m_topology,SIGNAL(currentIndexChanged(int)),m_gl,SLOT(setTopology(int)));
+  connect(m_ui->m_particleOrder,SIGNAL(currentIndexChanged(int)),m_gl,SLOT(setParticleOrder(int)));
+  //set solver settings, the thread count starts at 0 shown as Auto as the scheduler starts with one per core
+  connect(m_ui->m_numThreads,SIGNAL(valueChanged(int)),m_gl,SLOT(setNumThreads(int)));
+  connect(m_ui->m_batched,SIGNAL(toggled(bool)),m_gl,SLOT(toggleBatched(bool)));
+  connect(m_ui->m_solverType,SIGNAL(currentIndexChanged(int)),m_gl,SLOT(setSolverType(int)));
+  connect(m_ui->m_integratorType,SIGNAL(currentIndexChanged(int)),m_gl,SLOT(setIntegratorType(int)));
+  connect(m_ui->m_doublePrecision,SIGNAL(toggled(bool)),m_gl,SLOT(toggleDoublePrecision(bool)));
+  connect(m_ui->m_blockedSubsteps,SIGNAL(toggled(bool)),m_gl,SLOT(toggleBlockedSubsteps(bool)));
 }
 
 MainWindow::~MainWindow()
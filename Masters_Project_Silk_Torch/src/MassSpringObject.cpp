@@ -2,32 +2,57 @@
 #include "CustomDefs.h"
 #include "Utilities.h"
 #include "Logging.h"
+#include "SimdKernels.h"
 #include "glm/gtc/matrix_transform.hpp"
+#include <atomic>
+#include <cmath>
 
-MassSpringObject::MassSpringObject() : m_gridSize(10), m_impulseTime(0.0f), m_impulse(true), m_pos(glm::vec3(0.0f,0.0f,0.0f)),
+namespace
+{
+  ///The last mesh version given out, shared by every MassSpringObject so a regenerated flame never reuses one.
+  std::atomic<std::uint64_t> s_lastMeshVersion(0);
+}
+
+MassSpringObject::MassSpringObject() : m_gridSize(10), m_particleOrder(ParticleOrder::ROW_MAJOR), m_meshVersion(0), m_impulseTime(0.0f), m_impulse(true), m_pos(glm::vec3(0.0f,0.0f,0.0f)),
   m_scale(glm::vec3(1.0f,1.0f,1.0f)), m_impulseOnTime(1.0f), m_impulseOffTime(5.0f), m_boyancy(10.0f), m_windForce(glm::vec3(0.0f,0.0f,-5.0f)),
-  m_k(100.0f), m_damp(0.1f), m_restLength(1.0f), m_textureNum(0)
+  m_mass(10.0f), m_k(100.0f), m_damp(0.1f), m_restLength(1.0f), m_baseStiffness(1.0f),
+  m_topology(SpringTopology::STRUCTURAL), m_solverType(SolverType::EXPLICIT),
+  m_integratorType(IntegratorType::SYMPLECTIC_EULER), m_doublePrecision(false), m_blockedSubsteps(false), m_blockedExternalForces(1),
+  m_textureNum(0)
 {
   initialiseMassSpringObject(10.0f);
 }
 
-MassSpringObject::MassSpringObject(unsigned int _gridSize) : m_gridSize(_gridSize), m_impulseTime(0.0f), m_impulse(true),
+MassSpringObject::MassSpringObject(unsigned int _gridSize) : m_gridSize(_gridSize), m_particleOrder(ParticleOrder::ROW_MAJOR), m_meshVersion(0), m_impulseTime(0.0f), m_impulse(true),
   m_pos(glm::vec3(0.0f,0.0f,0.0f)), m_scale(glm::vec3(1.0f,1.0f,1.0f)), m_impulseOnTime(1.0f), m_impulseOffTime(5.0f), m_boyancy(10.0f),
-  m_windForce(glm::vec3(0.0f,0.0f,-5.0f)), m_k(100.0f), m_damp(0.1f), m_restLength(1.0f), m_textureNum(0)
+  m_windForce(glm::vec3(0.0f,0.0f,-5.0f)), m_mass(10.0f), m_k(100.0f), m_damp(0.1f), m_restLength(1.0f), m_baseStiffness(1.0f),
+  m_topology(SpringTopology::STRUCTURAL), m_solverType(SolverType::EXPLICIT),
+  m_integratorType(IntegratorType::SYMPLECTIC_EULER), m_doublePrecision(false), m_blockedSubsteps(false), m_blockedExternalForces(1),
+  m_textureNum(0)
 {
   initialiseMassSpringObject(10.0f);
 }
 
-MassSpringObject::MassSpringObject(unsigned int _gridSize, float _mass) : m_gridSize(_gridSize), m_impulseTime(0.0f), m_impulse(true),
+MassSpringObject::MassSpringObject(unsigned int _gridSize, float _mass) : m_gridSize(_gridSize), m_particleOrder(ParticleOrder::ROW_MAJOR), m_meshVersion(0), m_impulseTime(0.0f), m_impulse(true),
   m_pos(glm::vec3(0.0f,0.0f,0.0f)), m_scale(glm::vec3(1.0f,1.0f,1.0f)), m_impulseOnTime(1.0f), m_impulseOffTime(5.0f), m_boyancy(10.0f),
-  m_windForce(glm::vec3(0.0f,0.0f,-5.0f)), m_k(100.0f), m_damp(0.1f), m_restLength(1.0f), m_textureNum(0)
+  m_windForce(glm::vec3(0.0f,0.0f,-5.0f)), m_mass(10.0f), m_k(100.0f), m_damp(0.1f), m_restLength(1.0f), m_baseStiffness(1.0f),
+  m_topology(SpringTopology::STRUCTURAL), m_solverType(SolverType::EXPLICIT),
+  m_integratorType(IntegratorType::SYMPLECTIC_EULER), m_doublePrecision(false), m_blockedSubsteps(false), m_blockedExternalForces(1),
+  m_textureNum(0)
 {
   initialiseMassSpringObject(_mass);
 }
 
 void MassSpringObject::initialiseMassSpringObject(float _mass)
 {
+  m_mass = _mass;
+
+  // create the explicit solver
+  m_stepper = createStepper(m_integratorType, m_doublePrecision);
+
   // create the grid of particles
+  m_ordering.build(m_gridSize, m_particleOrder);
+  m_xpbdSolver.setPoints(m_ordering.getPoints());
   generateGrid(_mass);
 
   // create the springs
@@ -38,6 +63,7 @@ void MassSpringObject::initialiseMassSpringObject(float _mass)
 
   // generate the vertices
   generateVertices();
+  storePreviousVertices();
 
   // generate the normals
   generateNormals();
@@ -60,27 +86,27 @@ void MassSpringObject::setGridSize(unsigned int _gridSize)
   m_gridSize = _gridSize;
 }
 
-std::shared_ptr<MassPoint> MassSpringObject::getMassPoint(unsigned int _pointIndex)
+const ParticleStore &MassSpringObject::getParticles() const
 {
-  return m_points[_pointIndex];
+  return m_particles;
 }
 
-std::vector<GLshort> MassSpringObject::getIndices()
+const MeshIndices &MassSpringObject::getIndices() const
 {
   return m_indices;
 }
 
-std::vector<glm::vec2> MassSpringObject::getUVs()
+const std::vector<glm::vec2> &MassSpringObject::getUVs() const
 {
   return m_uvs;
 }
 
-std::vector<glm::vec3> MassSpringObject::getVertices()
+const std::vector<glm::vec3> &MassSpringObject::getVertices() const
 {
   return m_vertices;
 }
 
-std::vector<glm::vec3> MassSpringObject::getNormals()
+const std::vector<glm::vec3> &MassSpringObject::getNormals() const
 {
   return m_normals;
 }
@@ -106,6 +132,82 @@ void MassSpringObject::setScale(glm::vec3 _scale)
 }
 
 void MassSpringObject::update(float _dt)
+{
+  //keep the state before the step to draw between steps
+  swapPreviousVertices();
+
+  //work out the external forces, these are the same for every point
+  glm::vec3 externalForces = updateExternalForces(_dt);
+
+  //reset the internal forces
+  m_particles.clearForces();
+
+  //update the Springs and the points
+  switch (m_solverType)
+  {
+    case SolverType::EXPLICIT:
+    {
+      //only split the step when the springs or a gust would make it unstable
+      unsigned int numSubsteps = m_stepController.computeNumSubsteps(m_springs, m_particles, externalForces, _dt);
+      float substep = _dt / float(numSubsteps);
+      for (unsigned int i = 0; i < numSubsteps; ++i)
+      {
+        //the stepper leaves the spring forces in the accumulators
+        if (i > 0)
+        {
+          m_particles.clearForces();
+        }
+        m_stepper->step(m_springs, m_particles, externalForces, substep);
+      }
+      break;
+    }
+    case SolverType::IMPLICIT:
+      SimdKernels::computeSpringForcesParallel(m_springs, m_particles);
+      m_implicitSolver.integrate(m_springs, m_particles, externalForces, _dt);
+      break;
+    case SolverType::PROJECTIVE:
+      //the springs are solved by the projections so their forces are not needed
+      m_projectiveSolver.integrate(m_springs, m_particles, externalForces, _dt);
+      break;
+    case SolverType::XPBD:
+      //the springs are solved as constraints
+      m_xpbdSolver.integrate(m_springs, m_particles, externalForces, _dt);
+      break;
+    case SolverType::GRID_STENCIL:
+    {
+      //the same explicit step as the symplectic Euler stepper with the springs found from the grid
+      unsigned int numSubsteps = m_stepController.computeNumSubsteps(m_stencil, m_particles, externalForces, _dt);
+      float substep = _dt / float(numSubsteps);
+      if (m_blockedSubsteps && numSubsteps > 1)
+      {
+        //step the substeps a band of the grid at a time while it is in the cache
+        m_blockedExternalForces[0] = externalForces;
+        m_stencil.stepBlocked(m_particles, m_blockedExternalForces, substep, numSubsteps);
+      }
+      else
+      {
+        for (unsigned int i = 0; i < numSubsteps; ++i)
+        {
+          if (i > 0)
+          {
+            m_particles.clearForces();
+          }
+          m_stencil.computeForcesParallel(m_particles);
+          SimdKernels::integrateParallel(m_particles, externalForces, substep, 0, m_particles.size());
+        }
+      }
+      break;
+    }
+  }
+
+  //update the vertices of the MassSpringObject
+  updateVertices();
+
+  // generate the transformation matrix
+  generateTransform();
+}
+
+glm::vec3 MassSpringObject::updateExternalForces(float _dt)
 {
   //update the impulse time
   m_impulseTime += _dt;
@@ -126,60 +228,70 @@ void MassSpringObject::update(float _dt)
     //Logging::logI("IMPULSE");
   }
 
-  //apply the external forces to the points and reset the internal forces
-  for (auto point : m_points)
+  //the wind only acts while the impulse is on, the buoyancy always acts
+  glm::vec3 externalForces = glm::vec3(0.0f, m_boyancy, 0.0f);
+  if (m_impulse)
   {
-    if (m_impulse)
-    {
-      point->setExternalForces(m_windForce);
-    }
-    else
-    {
-      point->setExternalForces(glm::vec3(0.0f,0.0f,0.0f));
-    }
-    point->setExternalForces(glm::vec3(point->getExternalForces().x,m_boyancy,point->getExternalForces().z));
-    point->setInternalForces(glm::vec3(0.0f,0.0f,0.0f));
+    externalForces.x = m_windForce.x;
+    externalForces.z = m_windForce.z;
   }
+  return externalForces;
+}
 
-  //update the Springs
-  for (auto spring : m_springs)
-  {
-    spring->update();
-  }
-  //update the MassPoints
-  for (auto point : m_points)
+void MassSpringObject::updateFromBatch(const ParticleStore &_particles, std::size_t _offset)
+{
+  //keep the state before the step to draw between steps
+  swapPreviousVertices();
+
+  for (std::size_t i = 0; i < m_vertices.size(); ++i)
   {
-    point->update(_dt);
+    m_vertices[i] = _particles.getPos(_offset + i);
   }
 
-  //update the vertices of the MassSpringObject
-  updateVertices();
-
   // generate the transformation matrix
   generateTransform();
 }
 
+void MassSpringObject::copyParticlesFrom(const ParticleStore &_particles, std::size_t _offset)
+{
+  m_particles.copyState(_particles, _offset, m_particles.size(), 0);
+  m_stepper->reset();
+  updateVertices();
+  //there is no step between the copied state and the last one to draw across
+  storePreviousVertices();
+}
+
 void MassSpringObject::reset()
 {
-  //get the mass of the points
-  float mass = m_points[0]->getMass();
-  //empty the particle std::vector
-  m_points.resize(0);
+  //empty the particles
+  m_particles.clear();
   //empty the springs
-  m_springs.resize(0);
+  m_springs.clear();
   //generate the points
-  generateGrid(mass);
-  //update the vertices with the reset particles
+  generateGrid(m_mass);
+  //update the vertices with the reset particles, the reset is not blended with the old state
   updateVertices();
+  storePreviousVertices();
   //generate the springs
   generateSprings();
+  //the last solution is no use to the reset particles
+  m_implicitSolver.reset();
+  m_projectiveSolver.invalidate();
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
 }
 
-std::vector<std::shared_ptr<Spring> > MassSpringObject::getSprings()
+const SpringStore &MassSpringObject::getSprings() const
 {
   return m_springs;
 }
 
+const GridStencil &MassSpringObject::getStencil() const
+{
+  return m_stencil;
+}
+
 void MassSpringObject::generateGrid(float _mass)
 {
   /*
@@ -192,33 +304,38 @@ void MassSpringObject::generateGrid(float _mass)
   */
 
 
-  // create the grid of particles
-  for (unsigned int y = 0; y < m_gridSize; ++y)
+  // create the grid of particles, in the order they are stored in
+  std::size_t numPoints = std::size_t(m_gridSize) * m_gridSize;
+  m_particles.reserve(numPoints);
+  for (std::size_t i = 0; i < numPoints; ++i)
   {
-    for (unsigned int x = 0; x < m_gridSize; ++x)
-    {
-      // Generate the postion of the point bewteen 0 and the gird size
-      glm::vec3 newPos = glm::vec3(float(x),float(y), 0.0f);
+    unsigned int x = m_ordering.getPoint(i) % m_gridSize;
+    unsigned int y = m_ordering.getPoint(i) / m_gridSize;
 
-      //store the point in the std::vector
-      m_points.push_back(std::shared_ptr<MassPoint>(new MassPoint(_mass, newPos - (m_gridSize * 0.5f))));
-    }
+    // Generate the postion of the point bewteen 0 and the gird size
+    glm::vec3 newPos = glm::vec3(float(x),float(y), 0.0f);
+
+    //store the point in the particle store
+    m_particles.addParticle(newPos - (m_gridSize * 0.5f), _mass);
   }
 
   //lock bottom row
-  for (unsigned int i = 0; i < m_gridSize; i++)
+  for (unsigned int x = 0; x < m_gridSize; x++)
   {
-    m_points[i]->lock();
-    m_points[i]->setColour(glm::vec3(1.0f,0.0f,0.0f));
+    m_particles.lock(m_ordering.getIndex(x, 0));
   }
 }
 
 void MassSpringObject::generateIndices()
 {
-  unsigned int i = 0;
-
   float uvOffset = (1.0f / (m_gridSize - 1));
 
+  //the index type is picked from the number of points so big grids do not overflow it
+  std::size_t numPoints = std::size_t(m_gridSize) * m_gridSize;
+  m_indices.reset(numPoints);
+  m_indices.reserve(6 * (m_gridSize - 1) * std::size_t(m_gridSize - 1));
+  m_uvs.assign(numPoints, glm::vec2(0.0f, 0.0f));
+
   for (unsigned int y = 0; y < m_gridSize; y++)
   {
     for (unsigned int x = 0; x < m_gridSize; x++)
@@ -227,92 +344,162 @@ void MassSpringObject::generateIndices()
       if the current position is not the the last row or the last column then create an indices for the triangle,
       this check is to stop infinite triangles
       */
-      if (i < ((m_gridSize * m_gridSize) - m_gridSize) && x < m_gridSize - 1)
+      if (y < m_gridSize - 1 && x < m_gridSize - 1)
       {
-        i = (y * m_gridSize) + x;
+        //the corners of the square are looked up through the ordering so the triangles are the same in any order
+        std::size_t i = m_ordering.getIndex(x, y);
+        std::size_t above = m_ordering.getIndex(x, y + 1);
+        std::size_t aboveRight = m_ordering.getIndex(x + 1, y + 1);
+        std::size_t right = m_ordering.getIndex(x + 1, y);
         // adds the first triangle of the current square
-        m_indices.push_back(GLshort(i));
-        m_indices.push_back(GLshort(i + m_gridSize));
-        m_indices.push_back(GLshort(i + m_gridSize + 1));
+        m_indices.add(i);
+        m_indices.add(above);
+        m_indices.add(aboveRight);
         // adds the second triangle of the current square
-        m_indices.push_back(GLshort(i));
-        m_indices.push_back(GLshort(i + m_gridSize + 1));
-        m_indices.push_back(GLshort(i + 1));
+        m_indices.add(i);
+        m_indices.add(aboveRight);
+        m_indices.add(right);
       }
 
       //generate the texture coordinates
-      m_uvs.push_back(glm::vec2(float(x) * uvOffset,
-                                float(y) * uvOffset));
-      ++i;
+      m_uvs[m_ordering.getIndex(x, y)] = glm::vec2(float(x) * uvOffset,
+                                                   float(y) * uvOffset);
     }
   }
+
+  //anything holding the old indices and uv's can tell they have changed
+  m_meshVersion = ++s_lastMeshVersion;
 }
 
 void MassSpringObject::generateVertices()
 {
-  for (auto point : m_points)
+  for (std::size_t i = 0; i < m_particles.size(); ++i)
   {
-    m_vertices.push_back(point->getPos());
+    m_vertices.push_back(m_particles.getPos(i));
   }
 }
 
 void MassSpringObject::updateVertices()
 {
-  for (unsigned int i = 0; i < m_vertices.size(); ++i)
+  for (std::size_t i = 0; i < m_vertices.size(); ++i)
+  {
+    m_vertices[i] = m_particles.getPos(i);
+  }
+}
+
+void MassSpringObject::storePreviousVertices()
+{
+  //assign reuses the memory once the sizes match
+  m_previousVertices.assign(m_vertices.begin(), m_vertices.end());
+}
+
+void MassSpringObject::swapPreviousVertices()
+{
+  //the vertices are only swapped when the sizes match, otherwise the step would leave some of them unwritten
+  if (m_previousVertices.size() == m_vertices.size())
+  {
+    m_previousVertices.swap(m_vertices);
+  }
+  else
   {
-    m_vertices[i] = m_points[i]->getPos();
+    storePreviousVertices();
   }
 }
 
 void MassSpringObject::generateSprings()
 {
-  for (unsigned int i = 0; i < m_points.size(); ++i)
+  //the stencil finds the springs from the grid so only needs their settings
+  m_stencil.setGrid(m_gridSize, 1);
+  m_stencil.setStiffness(m_k);
+  m_stencil.setBaseStiffness(m_baseStiffness, c_baseRows);
+  m_stencil.setRestLength(m_restLength);
+  m_stencil.setDamping(m_damp);
+  bool shear = m_topology != SpringTopology::STRUCTURAL;
+  bool bend = m_topology == SpringTopology::SHEAR_AND_BEND;
+  m_stencil.setSprings(shear, bend);
+  if (m_solverType == SolverType::GRID_STENCIL)
+  {
+    return;
+  }
+
+  //every material is added whatever the topology so the indices are the same for every flame
+  m_springs.reserve((2 + (shear ? 2 : 0) + (bend ? 2 : 0)) * m_particles.size());
+  m_springs.setDamping(m_damp);
+  const float restLengths[3] = {m_restLength, m_restLength * std::sqrt(2.0f), m_restLength * 2.0f};
+  for (float restLength : restLengths)
+  {
+    m_springs.addMaterial(m_k, restLength);
+    m_springs.addMaterial(m_k * m_baseStiffness, restLength);
+  }
+
+  //each point is joined to the points below and to the left of it so every spring is only added once
+  //the SpringStore holds 32 bit point indices, enough for grids of over 65000 points a side
+  //the points are walked in the order they are stored so the springs near each other in the list share memory
+  for (std::uint32_t i = 0; i < std::uint32_t(m_particles.size()); ++i)
   {
-    //check if not on right side of the mass spring object
-    if (i % m_gridSize != 0)
+    unsigned int x = m_ordering.getPoint(i) % m_gridSize;
+    unsigned int y = m_ordering.getPoint(i) / m_gridSize;
+
+    //the other point is never above this one, so the spring is in the base when this point is
+    std::uint8_t base = (y < c_baseRows) ? 1 : 0;
+
+    //hoizontal and vertical Springs
+    if (x > 0)
+    {
+      m_springs.addSpring(i, m_ordering.getIndex(x - 1, y), c_structuralMaterial + base);
+    }
+    if (y > 0)
     {
-      //hoizontal Spring
-      std::shared_ptr<Spring> spring(new Spring(m_k, m_damp, m_restLength, i));
-      spring->setPlane('H');
-      spring->setPointA(m_points[i]);
-      spring->setPointB(m_points[i - 1]);
-      m_springs.push_back(spring);
+      m_springs.addSpring(i, m_ordering.getIndex(x, y - 1), c_structuralMaterial + base);
+    }
+
+    //diagonal Springs that stop the grid shearing
+    if (shear && y > 0)
+    {
+      if (x > 0)
+      {
+        m_springs.addSpring(i, m_ordering.getIndex(x - 1, y - 1), c_shearMaterial + base);
+      }
+      if (x < m_gridSize - 1)
+      {
+        m_springs.addSpring(i, m_ordering.getIndex(x + 1, y - 1), c_shearMaterial + base);
+      }
     }
 
-    //check if not on top side of the mass spring object
-    if (i < m_points.size() - m_gridSize)
+    //Springs that skip a point to stop the grid folding
+    if (bend)
     {
-      //vertical Spring
-      std::shared_ptr<Spring> spring(new Spring(m_k, m_damp, m_restLength, i));
-      spring->setPlane('V');
-      spring->setPointA(m_points[i + m_gridSize]);
-      spring->setPointB(m_points[i]);
-      m_springs.push_back(spring);
+      if (x > 1)
+      {
+        m_springs.addSpring(i, m_ordering.getIndex(x - 2, y), c_bendMaterial + base);
+      }
+      if (y > 1)
+      {
+        m_springs.addSpring(i, m_ordering.getIndex(x, y - 2), c_bendMaterial + base);
+      }
     }
   }
+
+  //split the springs into batches that can be updated in parallel
+  m_springs.buildColourBatches();
 }
 
-void MassSpringObject::buildVAOData()
+void MassSpringObject::packPositions(float _alpha, float *_positions) const
 {
-  for (unsigned int i = 0; i < u_int(m_vertices.size()); ++i)
+  //the vertices are tightly packed so the blend is one pass over contiguous floats
+  static_assert(sizeof(glm::vec3) == sizeof(float) * 3, "glm::vec3 must be three packed floats");
+  const float *previous = reinterpret_cast<const float *>(m_previousVertices.data());
+  const float *current = reinterpret_cast<const float *>(m_vertices.data());
+  std::size_t numFloats = m_vertices.size() * 3;
+  for (std::size_t i = 0; i < numFloats; ++i)
   {
-    m_vaoData.push_back(m_vertices[ulong(i)].x);
-    m_vaoData.push_back(m_vertices[ulong(i)].y);
-    m_vaoData.push_back(m_vertices[ulong(i)].z);
-    m_vaoData.push_back(m_uvs[ulong(i)].x);
-    m_vaoData.push_back(m_uvs[ulong(i)].y);
+    _positions[i] = glm::mix(previous[i], current[i], _alpha);
   }
 }
 
-void MassSpringObject::reBuildVAOData()
-{
-  m_vaoData.resize(0);
-  buildVAOData();
-}
-
-std::vector<float> MassSpringObject::getVAOData()
+std::uint64_t MassSpringObject::getMeshVersion() const
 {
-  return m_vaoData;
+  return m_meshVersion;
 }
 
 void MassSpringObject::setImpulseOnTime(float _impulseOnTime)
@@ -348,37 +535,145 @@ void MassSpringObject::setWindForce(char _axis, float _windForce)
 
 void MassSpringObject::setMass(float _mass)
 {
-  for (auto massPoint : m_points)
-  {
-    massPoint->setMass(_mass);
-  }
+  m_mass = _mass;
+  m_particles.setMass(_mass);
+  m_projectiveSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
 }
 
 void MassSpringObject::setSpringConstant(float _springConstant)
 {
   m_k = _springConstant;
-  for (auto spring : m_springs)
-  {
-    spring->setSpringConstant(_springConstant);
-  }
+  updateMaterials();
+  m_stencil.setStiffness(_springConstant);
+  m_projectiveSolver.invalidate();
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  //the acceleration kept by the Verlet stepper was computed with the old springs
+  m_stepper->reset();
 }
 
 void MassSpringObject::setDamping(float _damping)
 {
   m_damp = _damping;
-  for (auto spring : m_springs)
-  {
-    spring->setDamping(_damping);
-  }
+  m_springs.setDamping(_damping);
+  m_stencil.setDamping(_damping);
+  m_stepper->reset();
 }
 
 void MassSpringObject::setRestLength(float _restLength)
 {
   m_restLength = _restLength;
-  for (auto spring : m_springs)
+  updateMaterials();
+  m_stencil.setRestLength(_restLength);
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
+}
+
+void MassSpringObject::setBaseStiffness(float _baseStiffness)
+{
+  m_baseStiffness = _baseStiffness;
+  m_stencil.setBaseStiffness(_baseStiffness, c_baseRows);
+  updateMaterials();
+  m_projectiveSolver.invalidate();
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
+}
+
+void MassSpringObject::updateMaterials()
+{
+  //the materials are set from the settings rather than scaled from their old values, so a setting of zero is not kept
+  //each kind of spring has its base material after its body material
+  const float restLengths[3] = {m_restLength, m_restLength * std::sqrt(2.0f), m_restLength * 2.0f};
+  for (std::size_t material = 0; material + 1 < m_springs.getNumMaterials(); material += 2)
+  {
+    m_springs.setMaterialStiffness(std::uint8_t(material), m_k);
+    m_springs.setMaterialRestLength(std::uint8_t(material), restLengths[material / 2]);
+    m_springs.setMaterialStiffness(std::uint8_t(material + 1), m_k * m_baseStiffness);
+    m_springs.setMaterialRestLength(std::uint8_t(material + 1), restLengths[material / 2]);
+  }
+}
+
+void MassSpringObject::setTopology(SpringTopology _topology)
+{
+  m_topology = _topology;
+  m_springs.clear();
+  generateSprings();
+  m_implicitSolver.reset();
+  m_projectiveSolver.invalidate();
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
+}
+
+SpringTopology MassSpringObject::getTopology() const
+{
+  return m_topology;
+}
+
+void MassSpringObject::setParticleOrder(ParticleOrder _order)
+{
+  m_particleOrder = _order;
+  applyParticleOrder();
+}
+
+ParticleOrder MassSpringObject::getParticleOrder() const
+{
+  return m_particleOrder;
+}
+
+const GridOrdering &MassSpringObject::getOrdering() const
+{
+  return m_ordering;
+}
+
+void MassSpringObject::setSolverType(SolverType _solverType)
+{
+  m_solverType = _solverType;
+  applyParticleOrder();
+  if (_solverType == SolverType::GRID_STENCIL)
+  {
+    //the stencil needs no edge list so its memory is given back
+    m_springs = SpringStore();
+  }
+  else if (m_springs.size() == 0)
+  {
+    generateSprings();
+  }
+  m_implicitSolver.reset();
+  m_projectiveSolver.invalidate();
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
+}
+
+void MassSpringObject::setBlockedSubsteps(bool _blockedSubsteps)
+{
+  m_blockedSubsteps = _blockedSubsteps;
+}
+
+unsigned int MassSpringObject::getNumSubsteps() const
+{
+  if (m_solverType != SolverType::EXPLICIT && m_solverType != SolverType::GRID_STENCIL)
   {
-    spring->setRestLength(_restLength);
+    return 1;
   }
+  return m_stepController.getNumSubsteps();
+}
+
+SolverType MassSpringObject::getSolverType() const
+{
+  return m_solverType;
+}
+
+void MassSpringObject::setIntegrator(IntegratorType _integratorType, bool _doublePrecision)
+{
+  m_integratorType = _integratorType;
+  m_doublePrecision = _doublePrecision;
+  m_stepper = createStepper(_integratorType, _doublePrecision);
 }
 
 glm::mat4 MassSpringObject::getTransform()
@@ -398,26 +693,68 @@ int MassSpringObject::getTextureNum()
 
 void MassSpringObject::generateNormals()
 {
+  //the points are counted in row major order and looked up through the ordering
+  auto vertex = [this](std::size_t _point)
+  {
+    return m_vertices[m_ordering.getIndex(unsigned(_point % m_gridSize), unsigned(_point / m_gridSize))];
+  };
+
   //create the normals for all of the triangles
-  for (unsigned int i = 0; i < m_gridSize * m_gridSize; i++)
+  std::size_t numPoints = std::size_t(m_gridSize) * m_gridSize;
+  m_normals.assign(numPoints, glm::vec3(0.0f, 0.0f, 0.0f));
+  for (std::size_t i = 0; i < numPoints; i++)
   {
-    if (i >= (m_gridSize*m_gridSize) - m_gridSize - 1) //quick hack to get normal array size to match vertices array
+    glm::vec3 &normal = m_normals[m_ordering.getIndex(unsigned(i % m_gridSize), unsigned(i / m_gridSize))];
+    if (i >= numPoints - m_gridSize - 1) //quick hack to get normal array size to match vertices array
     {
-      m_normals.push_back(m_vertices[i]);
+      normal = vertex(i);
     }
     else if ((i % 2) == 0)//work out if the current index is a multiple of two and switch between the needed normal type to get accordingly
     {
-      glm::vec3 norm = getNormal(m_vertices[i], m_vertices[i + 1], m_vertices[i + m_gridSize]);
-      m_normals.push_back(norm);
+      normal = getNormal(vertex(i), vertex(i + 1), vertex(i + m_gridSize));
     }
     else
     {
-      glm::vec3 norm = getNormal(m_vertices[i + m_gridSize], m_vertices[i + 1], m_vertices[i + m_gridSize + 1]);
-      m_normals.push_back(norm);
+      normal = getNormal(vertex(i + m_gridSize), vertex(i + 1), vertex(i + m_gridSize + 1));
     }
   }
 }
 
+void MassSpringObject::applyParticleOrder()
+{
+  //the stencil finds the neighbours from fixed offsets along the rows
+  ParticleOrder order = (m_solverType == SolverType::GRID_STENCIL) ? ParticleOrder::ROW_MAJOR : m_particleOrder;
+  if (order == m_ordering.getOrder())
+  {
+    return;
+  }
+
+  //each particle is moved from where its point of the grid was stored
+  GridOrdering ordering;
+  ordering.build(m_gridSize, order);
+  std::vector<std::uint32_t> moveFrom(m_particles.size());
+  for (std::size_t i = 0; i < moveFrom.size(); ++i)
+  {
+    moveFrom[i] = m_ordering.getIndex(ordering.getPoint(i) % m_gridSize, ordering.getPoint(i) / m_gridSize);
+  }
+  m_ordering = ordering;
+  m_xpbdSolver.setPoints(m_ordering.getPoints());
+  m_particles.reorder(moveFrom);
+
+  //the springs, mesh and uv's all index the particles
+  m_springs.clear();
+  generateSprings();
+  generateIndices();
+  updateVertices();
+  storePreviousVertices();
+  generateNormals();
+  m_implicitSolver.reset();
+  m_projectiveSolver.invalidate();
+  m_xpbdSolver.invalidate();
+  m_stepController.invalidate();
+  m_stepper->reset();
+}
+
 void MassSpringObject::generateTransform()
 {
   //translate an identity matrix
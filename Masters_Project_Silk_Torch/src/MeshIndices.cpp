@@ -0,0 +1,75 @@
+#include "MeshIndices.h"
+
+MeshIndices::MeshIndices() : m_useInt(false)
+{
+}
+
+MeshIndices::~MeshIndices()
+{
+}
+
+void MeshIndices::reset(std::size_t _numVertices)
+{
+  //give back the memory of the type that is not used
+  std::vector<std::uint16_t>().swap(m_shortIndices);
+  std::vector<std::uint32_t>().swap(m_intIndices);
+  m_useInt = _numVertices > c_maxShortVertices;
+}
+
+void MeshIndices::reserve(std::size_t _count)
+{
+  if (m_useInt)
+  {
+    m_intIndices.reserve(_count);
+  }
+  else
+  {
+    m_shortIndices.reserve(_count);
+  }
+}
+
+void MeshIndices::add(std::size_t _index)
+{
+  if (m_useInt)
+  {
+    m_intIndices.push_back(std::uint32_t(_index));
+  }
+  else
+  {
+    m_shortIndices.push_back(std::uint16_t(_index));
+  }
+}
+
+std::size_t MeshIndices::size() const
+{
+  return m_useInt ? m_intIndices.size() : m_shortIndices.size();
+}
+
+bool MeshIndices::empty() const
+{
+  return size() == 0;
+}
+
+std::size_t MeshIndices::get(std::size_t _i) const
+{
+  return m_useInt ? std::size_t(m_intIndices[_i]) : std::size_t(m_shortIndices[_i]);
+}
+
+bool MeshIndices::getIsInt() const
+{
+  return m_useInt;
+}
+
+std::size_t MeshIndices::getIndexSize() const
+{
+  return m_useInt ? sizeof(std::uint32_t) : sizeof(std::uint16_t);
+}
+
+const void *MeshIndices::getData() const
+{
+  if (m_useInt)
+  {
+    return m_intIndices.data();
+  }
+  return m_shortIndices.data();
+}
@@ -3,15 +3,16 @@
 #include <ngl/Vec3.h>
 #include <ngl/NGLInit.h>
 #include <ngl/VAOPrimitives.h>
-#include <ngl/Texture.h>
 #include <QColorDialog>
-#include <ngl/SimpleIndexVAO.h>
-#include <random>
+#include <QImage>
 
 #include "CustomDefs.h"
+#include "SimdKernels.h"
 
-NGLScene::NGLScene( QWidget *_parent ) : QOpenGLWidget( _parent ), m_projectRunning(false), m_gridSize(10),
-  m_textured(true), m_timer(Timer()), m_dt(0.01f), m_frameRateTime(0.0f), m_frameRate(0), m_FPS(0), initRun(true)
+NGLScene::NGLScene( QWidget *_parent ) : QOpenGLWidget( _parent ), m_textureArray(0), m_instanced(true),
+  m_drawnInstanced(false), m_projectRunning(false), m_gridSize(10), m_textured(true), m_timer(Timer()), m_dt(0.01f),
+  m_frameRateTime(0.0f), m_frameRate(0), m_FPS(0), initRun(true), m_simulation(m_gridSize),
+  m_integratorType(IntegratorType::SYMPLECTIC_EULER), m_doublePrecision(false)
 {
   // set this widget to have the initial keyboard focus
   setFocus();
@@ -24,8 +25,8 @@ NGLScene::NGLScene( QWidget *_parent ) : QOpenGLWidget( _parent ), m_projectRunn
 
 	m_selectedObject=0;
 
-  //generate the MassSpringObjects
-  generateMassSpringObjects(0);
+  //log which kernels the solver picked for this CPU
+  Logging::logI("Solver kernels " + SimdKernels::isaToString(SimdKernels::getIsa()));
 
   //set the number of milliseconds the frame timer should run at
   m_timerMilliseconds = 1;
@@ -36,13 +37,14 @@ NGLScene::NGLScene( QWidget *_parent ) : QOpenGLWidget( _parent ), m_projectRunn
 
 NGLScene::~NGLScene()
 {
+  //stop stepping before the scene goes
+  m_simulation.stop();
   std::cout<<"Shutting down NGL, removing VAO's and Shaders\n";
-  m_vao->removeVAO();
+  makeCurrent();
+  m_flameMeshes.clear();
+  m_flameInstances.reset();
   // remove the texture
-  for (int i = 0; i < 9; i++)
-  {
-    glDeleteTextures(1,&m_textureName[i]);
-  }
+  glDeleteTextures(1,&m_textureArray);
 }
 
 // This virtual function is called once before the first call to paintGL() or resizeGL(),
@@ -68,20 +70,15 @@ void NGLScene::initializeGL()
   ngl::ShaderLib* shader = ngl::ShaderLib::instance();
   // load a frag and vert shaders
   initShader(shader, "TextureVertex", "TextureFragment", "TextureShader");
+  shader->setUniform("tex",0);
+  initShader(shader, "InstancedVertex", "InstancedFragment", "InstancedShader");
+  //the texture array is on unit 0 and the positions of the flames on unit 1
+  shader->setUniform("tex",0);
+  shader->setUniform("positions",1);
 
-  // load the flame textures
-  for (int i = 1; i <= 8; i++)
-  {
-    ngl::Texture texture("textures/texture" + std::to_string(i) + ".png");
-    m_textureName[i]=texture.setTextureGL();
-  }
-
-  // set the solid texture
-  ngl::Texture texture("textures/ratGrid.png");
-  m_textureName[8]=texture.setTextureGL();
-
-  buildVAO();
-  ngl::VAOFactory::listCreators();
+  // load the flame textures and the solid texture
+  buildTextureArray();
+  m_flameInstances.reset(new FlameInstances());
 
   // initalise the frame rate text
   m_frameRateText.reset(new  ngl::Text(QFont("Arial",18)));
@@ -98,70 +95,6 @@ void NGLScene::resizeGL( int _w, int _h )
   m_win.height = static_cast<int>( _h * devicePixelRatio() );
 }
 
-void NGLScene::buildVAO()
-{
-  // build the particle grid VAO
-  for (unsigned int i = 0; i < m_massSpringObjects.size(); ++i)
-  {
-    m_massSpringObjects[i]->buildVAOData();
-
-    // create a vao as a series of GL_TRIANGLES
-    m_vao=ngl::VAOFactory::createVAO(ngl::simpleIndexVAO,GL_TRIANGLES);
-    m_vao->bind();
-
-    // set the vao data
-    setVAOData(i);
-
-    // now unbind
-    m_vao->unbind();
-  }
-}
-
-void NGLScene::generateMassSpringObjects(int _numOfObjects)
-{
-  //the number of mass spring objects.
-  //has to be a perfect square
-  //e.g 1,4,9,16,25,36,49,64,81,100,121,144...
-  m_numMassSpringObjects = (_numOfObjects + 1) * (_numOfObjects + 1);
-  //calculate the square root of the number of mass spring objects
-  float sqrtNum = std::sqrt(float(m_numMassSpringObjects));
-  //calculate the scale of the massSpringObjects
-  m_MSOScale = 1.0f/sqrtNum;
-
-  //generate the mass spring objects
-  for (int i = 0; i < m_numMassSpringObjects; i++)
-  {
-    //initalise the initial mass spring object
-    m_massSpringObjects.push_back(std::shared_ptr<MassSpringObject>(new MassSpringObject(m_gridSize)));
-    m_massSpringObjects.back()->setScale(glm::vec3(m_MSOScale, m_MSOScale, m_MSOScale));
-
-    // pick a random texture
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0,7);
-    int textureNum = dis(gen);
-    m_massSpringObjects.back()->setTextureNum(textureNum);
-  }
-
-  if (m_numMassSpringObjects > 1)
-  {
-    //move the mass spring objects
-    unsigned long i = 0;
-    float gapWidth = (m_gridSize-1.0f) * m_MSOScale;
-    float coordTranslation = gapWidth * (sqrtNum * 0.5f) - (gapWidth*0.5f);
-    for (float y = 0; y < sqrtNum; y++)
-    {
-      float currentY = gapWidth * y;
-      for (float x = 0; x < sqrtNum; x++)
-      {
-        float currentX = gapWidth * x;
-        m_massSpringObjects[i]->setPos(glm::vec3(currentX - coordTranslation,currentY - coordTranslation,0.0f));
-        i++;
-      }
-    }
-  }
-}
-
 void NGLScene::initShader(ngl::ShaderLib* _shader, std::string _vertexShaderName, std::string _fragmentShaderName, std::string _shaderName)
 {
   //std::string PWD = std::getenv("PWD");
@@ -219,42 +152,63 @@ void NGLScene::paintGL()
   }
 
   ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-
-  (*shader)["TextureShader"]->use();
-
   ngl::Mat4 MVP= m_project*m_view*m_mouseGlobalTX;
-  shader->setUniform("MVP",MVP);
 
   //draw objects
 
-  //mass spring
-  for (unsigned int i = 0; i < m_massSpringObjects.size(); ++i)
-  {
-    // bind the active texture before drawing
-    if (m_textured)
-    {
-      glBindTexture(GL_TEXTURE_2D, m_textureName[m_massSpringObjects[i]->getTextureNum()]);
-    }
-    else
-    {
-      glBindTexture(GL_TEXTURE_2D, m_textureName[8]);
-    }
-
-    m_vao=ngl::VAOFactory::createVAO(ngl::simpleIndexVAO,GL_TRIANGLES);
-    m_vao->bind();
-
-    setVAOData(i);
+  //take the newest state of the flames, this never waits for the simulation thread
+  bool newSnapshot = m_simulation.updateSnapshot();
+  const FrameSnapshot &snapshot = m_simulation.getSnapshot();
 
-    ngl::Mat4 transform = m_massSpringObjects[i]->getTransform();
-    shader->setUniform("transform",transform);
+  //every flame reads its texture from a layer of the one texture array so it is only bound once
+  glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureArray);
+  int solidLayer = m_textured ? -1 : 8;
 
-    m_vao->draw();
-    m_vao->unbind();
+  //mass spring, drawn instanced when every flame has the same mesh and they fit in the texture buffer, otherwise one
+  //flame at a time, whichever way did not draw last frame uploads the positions again as its buffers are stale
+  if (m_instanced && m_flameInstances->update(snapshot, newSnapshot || !m_drawnInstanced, solidLayer))
+  {
+    (*shader)["InstancedShader"]->use();
+    shader->setUniform("MVP",MVP);
+    shader->setUniform("numVertices",m_flameInstances->getNumVertices());
+    m_flameInstances->draw();
+    m_drawnInstanced = true;
+  }
+  else
+  {
+    (*shader)["TextureShader"]->use();
+    shader->setUniform("MVP",MVP);
+    drawFlames(snapshot, newSnapshot || m_drawnInstanced, solidLayer);
+    m_drawnInstanced = false;
   }
 
   //draw text
   glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);
   m_frameRateText->renderText(10,10,"FPS: " + QString::number(m_FPS));
+  m_frameRateText->renderText(10,35,"Substeps: " + QString::number(snapshot.m_numSubsteps));
+
+  //stop the timer and get the time since the last frame
+  m_dt = float(m_timer.timerFinish());
+
+  //restart the timer
+  m_timer.timerStart();
+
+  //if the inital run reset the dt
+  if (initRun)
+  {
+    initRun = false;
+    m_dt = 0.01f;
+  }
+
+  //update the frame rate
+  m_frameRateTime += m_dt;
+  if (m_frameRateTime > 1.0f)
+  {
+    m_frameRateTime -= 1.0f;
+    m_FPS = m_frameRate;
+    m_frameRate = 0;
+  }
+  m_frameRate++;
 }
 
 void NGLScene::toggleWireframe(bool _mode	 )
@@ -268,11 +222,13 @@ void NGLScene::toggleTextured(bool _mode)
 {
   Logging::logI("Textured " + Logging::boolToString(_mode));
   m_textured=_mode;
-  //recreate the vao data
-  for (auto springObjects : m_massSpringObjects)
-  {
-    springObjects->reBuildVAOData();
-  }
+  update();
+}
+
+void NGLScene::toggleInstanced(bool _mode)
+{
+  Logging::logI("Instanced " + Logging::boolToString(_mode));
+  m_instanced=_mode;
   update();
 }
 
@@ -281,6 +237,7 @@ void NGLScene::runProject()
   if (!m_projectRunning)
   {
     Logging::logI("Start Project");
+    m_simulation.start();
     startTimer(m_timerMilliseconds);
     m_projectRunning = true;
     update();
@@ -294,165 +251,197 @@ void NGLScene::runProject()
 void NGLScene::restartProject()
 {
   Logging::logI("Restart Project");
-  for(auto massSpringObj : m_massSpringObjects)
-  {
-    massSpringObj->reset();
-  }
+  m_simulation.restart();
   update();
 }
 
 void NGLScene::setBuoyancy(double _buoyancy)
 {
-  for(auto massSpringObj : m_massSpringObjects)
-  {
-    massSpringObj->setBoyancy(float(_buoyancy));
-  }
+  m_simulation.setBuoyancy(float(_buoyancy));
   update();
 }
 
 void NGLScene::setWindImpulseOn(double _windImpulseOn)
 {
-  for(auto massSpringObj : m_massSpringObjects)
-  {
-    massSpringObj->setImpulseOnTime(float(_windImpulseOn));
-  }
+  m_simulation.setWindImpulseOn(float(_windImpulseOn));
   update();
 }
 
 void NGLScene::setWindImpulseOff(double _windImpulseOff)
 {
-  for(auto massSpringObj : m_massSpringObjects)
-  {
-    massSpringObj->setImpulseOffTime(float(_windImpulseOff));
-  }
+  m_simulation.setWindImpulseOff(float(_windImpulseOff));
   update();
 }
 
 void NGLScene::setWindForceX(double _x)
 {
-  for(auto massSpringObj : m_massSpringObjects)
-  {
-    massSpringObj->setWindForce('x',float(_x));
-  }
+  m_simulation.setWindForce('x',float(_x));
   update();
 }
 
 void NGLScene::setWindForceY(double _y)
 {
-  for(auto massSpringObj : m_massSpringObjects)
-  {
-    massSpringObj->setWindForce('y',float(_y));
-  }
+  m_simulation.setWindForce('y',float(_y));
   update();
 }
 
 void NGLScene::setWindForceZ(double _z)
 {
-  for(auto massSpringObj : m_massSpringObjects)
-  {
-    massSpringObj->setWindForce('z',float(_z));
-  }
+  m_simulation.setWindForce('z',float(_z));
   update();
 }
 
 void NGLScene::setMass(double _mass)
 {
-  for(auto massSpringObj : m_massSpringObjects)
-  {
-    massSpringObj->setMass(float(_mass));
-  }
+  m_simulation.setMass(float(_mass));
 }
 
 void NGLScene::setSpringConstant(double _springConstant)
 {
-  for(auto massSpringObj : m_massSpringObjects)
-  {
-    massSpringObj->setSpringConstant(float(_springConstant));
-  }
+  m_simulation.setSpringConstant(float(_springConstant));
 }
 
 void NGLScene::setDamping(double _damping)
 {
-  for(auto massSpringObj : m_massSpringObjects)
-  {
-    massSpringObj->setDamping(float(_damping));
-  }
+  m_simulation.setDamping(float(_damping));
 }
 
 void NGLScene::setRestLength(double _restLength)
 {
-  for(auto massSpringObj : m_massSpringObjects)
-  {
-    massSpringObj->setRestLength(float(_restLength));
-  }
+  m_simulation.setRestLength(float(_restLength));
 }
 
-void NGLScene::setNumOfObject(int _numOfObjects)
+void NGLScene::setBaseStiffness(double _baseStiffness)
 {
-  //empty the MassSpringObjects vector
-  m_massSpringObjects.resize(0);
+  m_simulation.setBaseStiffness(float(_baseStiffness));
+}
 
-  //generate the MassSpringObjects
-  generateMassSpringObjects(_numOfObjects);
+void NGLScene::setTopology(int _topology)
+{
+  m_simulation.setTopology(SpringTopology(_topology));
+}
 
-  //recreate the vao data
-  for (auto springObjects : m_massSpringObjects)
-  {
-    //update the mass spring point
-    springObjects->update(m_dt);
-    springObjects->reBuildVAOData();
-  }
+void NGLScene::setParticleOrder(int _order)
+{
+  m_simulation.setParticleOrder(ParticleOrder(_order));
+}
+
+void NGLScene::setNumOfObject(int _numOfObjects)
+{
+  //generate the MassSpringObjects
+  m_simulation.generateFlames(_numOfObjects);
   update();
 }
 
-void NGLScene::timerEvent(QTimerEvent *_event)
-{  
-  //stop the timer and get dt
-  m_dt = float(m_timer.timerFinish());
+void NGLScene::setGridSize(int _gridSize)
+{
+  Logging::logI("Grid size " + std::to_string(_gridSize));
+  m_gridSize = unsigned(_gridSize);
+  m_simulation.setGridSize(m_gridSize);
+}
 
-  //restart the timer
-  m_timer.timerStart();
+void NGLScene::setNumThreads(int _numThreads)
+{
+  Logging::logI("Solver threads " + std::to_string(_numThreads));
+  m_simulation.setNumThreads(unsigned(_numThreads));
+}
 
-  //if the inital run reset the dt
-  if (initRun)
-  {
-    initRun = false;
-    m_dt = 0.01f;
-  }
+void NGLScene::toggleBatched(bool _mode)
+{
+  Logging::logI("Batched " + Logging::boolToString(_mode));
+  m_simulation.setBatched(_mode);
+}
 
-  //mass spring
-  for (auto springObjects : m_massSpringObjects)
-  {
-    //update the mass spring point
-    springObjects->update(m_dt);
+void NGLScene::setSolverType(int _solverType)
+{
+  Logging::logI("Solver type " + std::to_string(_solverType));
+  m_simulation.setSolverType(SolverType(_solverType));
+}
 
-    //recreate the vao data
-    springObjects->reBuildVAOData();
-  }
+void NGLScene::setIntegratorType(int _integratorType)
+{
+  Logging::logI("Integrator type " + std::to_string(_integratorType));
+  m_integratorType = IntegratorType(_integratorType);
+  m_simulation.setIntegrator(m_integratorType, m_doublePrecision);
+}
+
+void NGLScene::toggleDoublePrecision(bool _mode)
+{
+  Logging::logI("Double precision " + Logging::boolToString(_mode));
+  m_doublePrecision = _mode;
+  m_simulation.setIntegrator(m_integratorType, m_doublePrecision);
+}
+
+void NGLScene::toggleBlockedSubsteps(bool _mode)
+{
+  Logging::logI("Blocked substeps " + Logging::boolToString(_mode));
+  m_simulation.setBlockedSubsteps(_mode);
+}
 
-  // Update and redraw
+void NGLScene::timerEvent(QTimerEvent *_event)
+{
+  //the flames are stepped on the simulation thread, this only redraws them with its newest snapshot
   update();
+}
 
-  //update the frame rate
-  m_frameRateTime += m_dt;
-  if (m_frameRateTime > 1.0f)
+void NGLScene::buildTextureArray()
+{
+  //the flame textures are the first layers so a flame's texture number is its layer, the solid texture is layer 8
+  std::vector<std::string> fileNames;
+  for (int i = 1; i <= 8; i++)
   {
-    m_frameRateTime -= 1.0f;
-    m_FPS = m_frameRate;
-    m_frameRate = 0;
+    fileNames.push_back("textures/texture" + std::to_string(i) + ".png");
   }
-  m_frameRate++;
+  fileNames.push_back("textures/ratGrid.png");
+
+  //every layer has to be the same size so the textures are scaled to the first
+  QImage first(QString::fromStdString(fileNames[0]));
+  int width = first.width();
+  int height = first.height();
+
+  glGenTextures(1,&m_textureArray);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureArray);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY,0,GL_RGBA8,width,height,GLsizei(fileNames.size()),0,GL_RGBA,GL_UNSIGNED_BYTE,nullptr);
+  for (std::size_t i = 0; i < fileNames.size(); ++i)
+  {
+    //flipped the same as ngl::Texture so the uv's match
+    QImage image = QImage(QString::fromStdString(fileNames[i])).convertToFormat(QImage::Format_RGBA8888).mirrored();
+    if (image.width() != width || image.height() != height)
+    {
+      image = image.scaled(width,height);
+    }
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY,0,0,0,GLint(i),width,height,1,GL_RGBA,GL_UNSIGNED_BYTE,image.constBits());
+  }
+  glTexParameteri(GL_TEXTURE_2D_ARRAY,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+  glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 }
 
-void NGLScene::setVAOData(unsigned int _massSpringIndex)
+void NGLScene::drawFlames(const FrameSnapshot &_snapshot, bool _uploadPositions, int _solidLayer)
 {
-  //set the data for the vao
-  m_vao->setData(ngl::SimpleIndexVAO::VertexData(m_massSpringObjects[_massSpringIndex]->getVAOData().size() * sizeof(float),
-                                                   m_massSpringObjects[_massSpringIndex]->getVAOData()[0],
-                                                   uint(m_massSpringObjects[_massSpringIndex]->getIndices().size()),
-                                                   &m_massSpringObjects[_massSpringIndex]->getIndices()[0],
-                                                   GL_UNSIGNED_SHORT));
-    m_vao->setVertexAttributePointer(0,3,GL_FLOAT,sizeof(float) * 5,0);
-    m_vao->setVertexAttributePointer(2,2,GL_FLOAT,sizeof(float) * 5,3);
-    m_vao->setNumIndices(m_massSpringObjects[_massSpringIndex]->getIndices().size());
+  //keep a mesh for each flame, a new mesh has no positions yet
+  std::size_t numMeshes = m_flameMeshes.size();
+  m_flameMeshes.resize(_snapshot.m_flames.size());
+  for (std::size_t i = numMeshes; i < m_flameMeshes.size(); ++i)
+  {
+    m_flameMeshes[i].reset(new FlameMesh());
+  }
+
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  for (std::size_t i = 0; i < _snapshot.m_flames.size(); ++i)
+  {
+    const FlameSnapshot &flame = _snapshot.m_flames[i];
+
+    // pick the layer of the texture array before drawing
+    shader->setUniform("layer",(_solidLayer < 0) ? flame.m_textureNum : _solidLayer);
+
+    //the positions only need uploading when the simulation has published new ones
+    m_flameMeshes[i]->update(flame, _uploadPositions || i >= numMeshes);
+
+    ngl::Mat4 transform = flame.m_transform;
+    shader->setUniform("transform",transform);
+
+    m_flameMeshes[i]->draw();
+  }
 }
@@ -0,0 +1,248 @@
+#include "ParticleStore.h"
+#include <algorithm>
+
+namespace
+{
+  /**
+  @brief Moves the values of an array into a new order.
+  @param[in,out] _values The array.
+  @param[in] _order The index each value is moved from.
+  */
+  template <typename T>
+  void gatherArray(std::vector<T> &_values, const std::vector<std::uint32_t> &_order)
+  {
+    std::vector<T> reordered(_values.size());
+    for (std::size_t i = 0; i < _order.size(); ++i)
+    {
+      reordered[i] = _values[_order[i]];
+    }
+    _values.swap(reordered);
+  }
+}
+
+ParticleStore::ParticleStore()
+{
+}
+
+ParticleStore::~ParticleStore()
+{
+}
+
+void ParticleStore::clear()
+{
+  m_posX.clear();
+  m_posY.clear();
+  m_posZ.clear();
+  m_velX.clear();
+  m_velY.clear();
+  m_velZ.clear();
+  m_forceX.clear();
+  m_forceY.clear();
+  m_forceZ.clear();
+  m_invMass.clear();
+  m_locked.clear();
+}
+
+void ParticleStore::reserve(std::size_t _count)
+{
+  m_posX.reserve(_count);
+  m_posY.reserve(_count);
+  m_posZ.reserve(_count);
+  m_velX.reserve(_count);
+  m_velY.reserve(_count);
+  m_velZ.reserve(_count);
+  m_forceX.reserve(_count);
+  m_forceY.reserve(_count);
+  m_forceZ.reserve(_count);
+  m_invMass.reserve(_count);
+  m_locked.reserve(_count);
+}
+
+std::size_t ParticleStore::addParticle(glm::vec3 _pos, float _mass)
+{
+  m_posX.push_back(_pos.x);
+  m_posY.push_back(_pos.y);
+  m_posZ.push_back(_pos.z);
+  m_velX.push_back(0.0f);
+  m_velY.push_back(0.0f);
+  m_velZ.push_back(0.0f);
+  m_forceX.push_back(0.0f);
+  m_forceY.push_back(0.0f);
+  m_forceZ.push_back(0.0f);
+  m_invMass.push_back(1.0f / _mass);
+  m_locked.push_back(0);
+
+  return m_posX.size() - 1;
+}
+
+void ParticleStore::append(const ParticleStore &_other)
+{
+  m_posX.insert(m_posX.end(), _other.m_posX.begin(), _other.m_posX.end());
+  m_posY.insert(m_posY.end(), _other.m_posY.begin(), _other.m_posY.end());
+  m_posZ.insert(m_posZ.end(), _other.m_posZ.begin(), _other.m_posZ.end());
+  m_velX.insert(m_velX.end(), _other.m_velX.begin(), _other.m_velX.end());
+  m_velY.insert(m_velY.end(), _other.m_velY.begin(), _other.m_velY.end());
+  m_velZ.insert(m_velZ.end(), _other.m_velZ.begin(), _other.m_velZ.end());
+  m_forceX.insert(m_forceX.end(), _other.m_forceX.begin(), _other.m_forceX.end());
+  m_forceY.insert(m_forceY.end(), _other.m_forceY.begin(), _other.m_forceY.end());
+  m_forceZ.insert(m_forceZ.end(), _other.m_forceZ.begin(), _other.m_forceZ.end());
+  m_invMass.insert(m_invMass.end(), _other.m_invMass.begin(), _other.m_invMass.end());
+  m_locked.insert(m_locked.end(), _other.m_locked.begin(), _other.m_locked.end());
+}
+
+void ParticleStore::copyState(const ParticleStore &_source, std::size_t _sourceBegin, std::size_t _count, std::size_t _destBegin)
+{
+  std::copy_n(_source.m_posX.begin() + long(_sourceBegin), _count, m_posX.begin() + long(_destBegin));
+  std::copy_n(_source.m_posY.begin() + long(_sourceBegin), _count, m_posY.begin() + long(_destBegin));
+  std::copy_n(_source.m_posZ.begin() + long(_sourceBegin), _count, m_posZ.begin() + long(_destBegin));
+  std::copy_n(_source.m_velX.begin() + long(_sourceBegin), _count, m_velX.begin() + long(_destBegin));
+  std::copy_n(_source.m_velY.begin() + long(_sourceBegin), _count, m_velY.begin() + long(_destBegin));
+  std::copy_n(_source.m_velZ.begin() + long(_sourceBegin), _count, m_velZ.begin() + long(_destBegin));
+}
+
+void ParticleStore::reorder(const std::vector<std::uint32_t> &_order)
+{
+  gatherArray(m_posX, _order);
+  gatherArray(m_posY, _order);
+  gatherArray(m_posZ, _order);
+  gatherArray(m_velX, _order);
+  gatherArray(m_velY, _order);
+  gatherArray(m_velZ, _order);
+  gatherArray(m_forceX, _order);
+  gatherArray(m_forceY, _order);
+  gatherArray(m_forceZ, _order);
+  gatherArray(m_invMass, _order);
+  gatherArray(m_locked, _order);
+}
+
+void ParticleStore::assign(const ParticleStore &_source, std::size_t _begin, std::size_t _count)
+{
+  long begin = long(_begin);
+  long end = long(_begin + _count);
+  m_posX.assign(_source.m_posX.begin() + begin, _source.m_posX.begin() + end);
+  m_posY.assign(_source.m_posY.begin() + begin, _source.m_posY.begin() + end);
+  m_posZ.assign(_source.m_posZ.begin() + begin, _source.m_posZ.begin() + end);
+  m_velX.assign(_source.m_velX.begin() + begin, _source.m_velX.begin() + end);
+  m_velY.assign(_source.m_velY.begin() + begin, _source.m_velY.begin() + end);
+  m_velZ.assign(_source.m_velZ.begin() + begin, _source.m_velZ.begin() + end);
+  m_forceX.assign(_count, 0.0f);
+  m_forceY.assign(_count, 0.0f);
+  m_forceZ.assign(_count, 0.0f);
+  m_invMass.assign(_source.m_invMass.begin() + begin, _source.m_invMass.begin() + end);
+  m_locked.assign(_source.m_locked.begin() + begin, _source.m_locked.begin() + end);
+}
+
+void ParticleStore::swapState(ParticleStore &_other)
+{
+  m_posX.swap(_other.m_posX);
+  m_posY.swap(_other.m_posY);
+  m_posZ.swap(_other.m_posZ);
+  m_velX.swap(_other.m_velX);
+  m_velY.swap(_other.m_velY);
+  m_velZ.swap(_other.m_velZ);
+}
+
+std::size_t ParticleStore::size() const
+{
+  return m_posX.size();
+}
+
+glm::vec3 ParticleStore::getPos(std::size_t _index) const
+{
+  return glm::vec3(m_posX[_index], m_posY[_index], m_posZ[_index]);
+}
+
+void ParticleStore::setPos(std::size_t _index, glm::vec3 _pos)
+{
+  m_posX[_index] = _pos.x;
+  m_posY[_index] = _pos.y;
+  m_posZ[_index] = _pos.z;
+}
+
+glm::vec3 ParticleStore::getVel(std::size_t _index) const
+{
+  return glm::vec3(m_velX[_index], m_velY[_index], m_velZ[_index]);
+}
+
+void ParticleStore::setVel(std::size_t _index, glm::vec3 _vel)
+{
+  m_velX[_index] = _vel.x;
+  m_velY[_index] = _vel.y;
+  m_velZ[_index] = _vel.z;
+}
+
+glm::vec3 ParticleStore::getForce(std::size_t _index) const
+{
+  return glm::vec3(m_forceX[_index], m_forceY[_index], m_forceZ[_index]);
+}
+
+void ParticleStore::addForce(std::size_t _index, glm::vec3 _force)
+{
+  m_forceX[_index] += _force.x;
+  m_forceY[_index] += _force.y;
+  m_forceZ[_index] += _force.z;
+}
+
+void ParticleStore::clearForces()
+{
+  std::fill(m_forceX.begin(), m_forceX.end(), 0.0f);
+  std::fill(m_forceY.begin(), m_forceY.end(), 0.0f);
+  std::fill(m_forceZ.begin(), m_forceZ.end(), 0.0f);
+}
+
+float ParticleStore::getMass(std::size_t _index) const
+{
+  return 1.0f / m_invMass[_index];
+}
+
+void ParticleStore::setMass(float _mass)
+{
+  std::fill(m_invMass.begin(), m_invMass.end(), 1.0f / _mass);
+}
+
+void ParticleStore::lock(std::size_t _index)
+{
+  m_locked[_index] = 1;
+}
+
+void ParticleStore::unlock(std::size_t _index)
+{
+  m_locked[_index] = 0;
+}
+
+bool ParticleStore::getIsLocked(std::size_t _index) const
+{
+  return m_locked[_index] != 0;
+}
+
+void ParticleStore::integrate(glm::vec3 _externalForce, float _dt)
+{
+  integrate(_externalForce, _dt, 0, m_posX.size());
+}
+
+void ParticleStore::integrate(glm::vec3 _externalForce, float _dt, std::size_t _begin, std::size_t _end)
+{
+  for (std::size_t i = _begin; i < _end; ++i)
+  {
+    //only update if the particle is unlocked
+    if (m_locked[i])
+    {
+      continue;
+    }
+
+    //calculate the acceleration of the particle from the net force
+    float accelerationX = (m_forceX[i] + _externalForce.x) * m_invMass[i];
+    float accelerationY = (m_forceY[i] + _externalForce.y) * m_invMass[i];
+    float accelerationZ = (m_forceZ[i] + _externalForce.z) * m_invMass[i];
+
+    //calculate the velocity of the particle
+    m_velX[i] += accelerationX * _dt;
+    m_velY[i] += accelerationY * _dt;
+    m_velZ[i] += accelerationZ * _dt;
+
+    //calculate the position of the particle
+    m_posX[i] += m_velX[i] * _dt;
+    m_posY[i] += m_velY[i] * _dt;
+    m_posZ[i] += m_velZ[i] * _dt;
+  }
+}
@@ -0,0 +1,310 @@
+#include "ProjectiveSolver.h"
+#include "SimdKernels.h"
+#include "TaskScheduler.h"
+#include "Logging.h"
+#include <algorithm>
+#include <deque>
+#include <cstdlib>
+
+namespace
+{
+  ///The factor is reused while the delta time stays within this ratio of the one it was built for.
+  const float c_factorDtRatio = 1.25f;
+}
+
+ProjectiveSolver::ProjectiveSolver() : m_factorised(false), m_factorDt(0.0f), m_factorParticles(0), m_factorSprings(0),
+  m_iterations(10), m_numFactorisations(0)
+{
+}
+
+ProjectiveSolver::~ProjectiveSolver()
+{
+}
+
+void ProjectiveSolver::integrate(const SpringStore &_springs, ParticleStore &_particles, glm::vec3 _externalForce, float _dt)
+{
+  std::size_t numParticles = _particles.size();
+
+  //the timer dt jitters from frame to frame so the factor is only rebuilt when it drifts a long way
+  if (!m_factorised || m_factorParticles != numParticles || m_factorSprings != _springs.size() ||
+      _dt > m_factorDt * c_factorDtRatio || _dt * c_factorDtRatio < m_factorDt)
+  {
+    factorise(_springs, _particles, _dt);
+  }
+
+  //the inertial target is where the particles go with no springs, the damping is taken from the start of the step
+  const float *invMass = _particles.getInvMass();
+  float damping = _springs.getDamping();
+  for (std::size_t i = 0; i < numParticles; ++i)
+  {
+    glm::vec3 pos = _particles.getPos(i);
+    if (m_rows[i] < 0)
+    {
+      m_targets[i] = pos;
+    }
+    else
+    {
+      glm::vec3 vel = _particles.getVel(i);
+      glm::vec3 force = _particles.getForce(i) + _externalForce - (damping * m_numAttached[i] * vel);
+      m_targets[i] = pos + (_dt * vel) + (_dt * _dt * invMass[i] * force);
+    }
+    m_positions[i] = m_targets[i];
+  }
+
+  TaskScheduler &scheduler = TaskScheduler::instance();
+  for (unsigned int iteration = 0; iteration < m_iterations; ++iteration)
+  {
+    //local step, the springs are independent
+    if (_springs.size() < SimdKernels::c_parallelThreshold)
+    {
+      project(_springs, 0, _springs.size());
+    }
+    else
+    {
+      scheduler.parallelFor(0, _springs.size(), SimdKernels::c_parallelGrainSize, [this, &_springs](std::size_t _begin, std::size_t _end)
+      {
+        project(_springs, _begin, _end);
+      });
+    }
+
+    //global step, build the right hand side from the targets and the projections
+    for (std::size_t row = 0; row < m_rowParticles.size(); ++row)
+    {
+      std::size_t particle = m_rowParticles[row];
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        m_rhs[axis][row] = m_inertia[particle] * double(m_targets[particle][axis]);
+      }
+    }
+    for (std::size_t i = 0; i < _springs.size(); ++i)
+    {
+      std::int64_t rowA = m_rows[_springs.getPointA(i)];
+      std::int64_t rowB = m_rows[_springs.getPointB(i)];
+      double stiffness = double(_springs.getStiffness(i));
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        double projection = stiffness * double(m_projections[i][axis]);
+        if (rowA >= 0)
+        {
+          m_rhs[axis][std::size_t(rowA)] -= projection;
+          //a locked point b is moved to the right hand side
+          if (rowB < 0)
+          {
+            m_rhs[axis][std::size_t(rowA)] += stiffness * double(m_positions[_springs.getPointB(i)][axis]);
+          }
+        }
+        if (rowB >= 0)
+        {
+          m_rhs[axis][std::size_t(rowB)] += projection;
+          if (rowA < 0)
+          {
+            m_rhs[axis][std::size_t(rowB)] += stiffness * double(m_positions[_springs.getPointA(i)][axis]);
+          }
+        }
+      }
+    }
+
+    //the three axes share the factor and solve at the same time
+    scheduler.parallelFor(0, 3, 1, [this](std::size_t _begin, std::size_t _end)
+    {
+      for (std::size_t axis = _begin; axis < _end; ++axis)
+      {
+        m_factor.solve(m_rhs[axis]);
+      }
+    });
+
+    for (std::size_t row = 0; row < m_rowParticles.size(); ++row)
+    {
+      m_positions[m_rowParticles[row]] = glm::vec3(float(m_rhs[0][row]), float(m_rhs[1][row]), float(m_rhs[2][row]));
+    }
+  }
+
+  //the velocity is the distance moved over the step
+  for (std::size_t i = 0; i < numParticles; ++i)
+  {
+    if (m_rows[i] < 0)
+    {
+      continue;
+    }
+    _particles.setVel(i, (m_positions[i] - _particles.getPos(i)) / _dt);
+    _particles.setPos(i, m_positions[i]);
+  }
+}
+
+void ProjectiveSolver::invalidate()
+{
+  m_factorised = false;
+}
+
+void ProjectiveSolver::setIterations(unsigned int _iterations)
+{
+  m_iterations = _iterations;
+}
+
+unsigned int ProjectiveSolver::getIterations() const
+{
+  return m_iterations;
+}
+
+unsigned int ProjectiveSolver::getNumFactorisations() const
+{
+  return m_numFactorisations;
+}
+
+std::size_t ProjectiveSolver::getBandwidth() const
+{
+  return m_factor.getBandwidth();
+}
+
+void ProjectiveSolver::factorise(const SpringStore &_springs, const ParticleStore &_particles, float _dt)
+{
+  std::size_t numParticles = _particles.size();
+  const std::uint8_t *locked = _particles.getLocked();
+  const float *invMass = _particles.getInvMass();
+
+  //build the neighbours of the free particles
+  std::vector<std::vector<std::uint32_t>> neighbours(numParticles);
+  m_numAttached.assign(numParticles, 0.0f);
+  for (std::size_t i = 0; i < _springs.size(); ++i)
+  {
+    std::uint32_t a = _springs.getPointA(i);
+    std::uint32_t b = _springs.getPointB(i);
+    m_numAttached[a] += 1.0f;
+    m_numAttached[b] += 1.0f;
+    if (!locked[a] && !locked[b])
+    {
+      neighbours[a].push_back(b);
+      neighbours[b].push_back(a);
+    }
+  }
+
+  //order each connected group of free particles breadth first from its lowest degree particle, lowest degree
+  //neighbours first
+  std::vector<std::size_t> order;
+  std::vector<std::uint8_t> visited(numParticles, 0);
+  std::vector<std::size_t> bySize;
+  for (std::size_t i = 0; i < numParticles; ++i)
+  {
+    if (!locked[i])
+    {
+      bySize.push_back(i);
+    }
+    std::sort(neighbours[i].begin(), neighbours[i].end(), [&neighbours](std::uint32_t _a, std::uint32_t _b)
+    {
+      return neighbours[_a].size() < neighbours[_b].size();
+    });
+  }
+  std::stable_sort(bySize.begin(), bySize.end(), [&neighbours](std::size_t _a, std::size_t _b)
+  {
+    return neighbours[_a].size() < neighbours[_b].size();
+  });
+  for (auto start : bySize)
+  {
+    if (visited[start])
+    {
+      continue;
+    }
+    std::deque<std::size_t> queue(1, start);
+    visited[start] = 1;
+    while (!queue.empty())
+    {
+      std::size_t current = queue.front();
+      queue.pop_front();
+      order.push_back(current);
+      for (auto neighbour : neighbours[current])
+      {
+        if (!visited[neighbour])
+        {
+          visited[neighbour] = 1;
+          queue.push_back(neighbour);
+        }
+      }
+    }
+  }
+
+  //reversing the order keeps the same band but gives less fill in the factor
+  std::reverse(order.begin(), order.end());
+  m_rowParticles = order;
+  m_rows.assign(numParticles, -1);
+  for (std::size_t row = 0; row < order.size(); ++row)
+  {
+    m_rows[order[row]] = std::int64_t(row);
+  }
+
+  std::size_t bandwidth = 0;
+  for (std::size_t i = 0; i < numParticles; ++i)
+  {
+    for (auto neighbour : neighbours[i])
+    {
+      bandwidth = std::max(bandwidth, std::size_t(std::abs(m_rows[i] - m_rows[neighbour])));
+    }
+  }
+
+  //the global matrix is M / dt^2 plus the stiffness weighted Laplacian of the springs
+  double dtSquared = double(_dt) * double(_dt);
+  m_inertia.resize(numParticles);
+  m_factor.resize(order.size(), bandwidth);
+  for (std::size_t i = 0; i < numParticles; ++i)
+  {
+    m_inertia[i] = 1.0 / (double(invMass[i]) * dtSquared);
+    if (m_rows[i] >= 0)
+    {
+      m_factor.add(std::size_t(m_rows[i]), std::size_t(m_rows[i]), m_inertia[i]);
+    }
+  }
+  for (std::size_t i = 0; i < _springs.size(); ++i)
+  {
+    std::int64_t rowA = m_rows[_springs.getPointA(i)];
+    std::int64_t rowB = m_rows[_springs.getPointB(i)];
+    double stiffness = double(_springs.getStiffness(i));
+    if (rowA >= 0)
+    {
+      m_factor.add(std::size_t(rowA), std::size_t(rowA), stiffness);
+    }
+    if (rowB >= 0)
+    {
+      m_factor.add(std::size_t(rowB), std::size_t(rowB), stiffness);
+    }
+    if (rowA >= 0 && rowB >= 0)
+    {
+      m_factor.add(std::size_t(std::max(rowA, rowB)), std::size_t(std::min(rowA, rowB)), -stiffness);
+    }
+  }
+
+  if (!m_factor.factorise())
+  {
+    Logging::logE("Projective dynamics matrix is not positive definite");
+  }
+
+  m_targets.resize(numParticles);
+  m_positions.resize(numParticles);
+  m_projections.resize(_springs.size());
+  for (auto &rhs : m_rhs)
+  {
+    rhs.resize(order.size());
+  }
+
+  m_factorised = true;
+  m_factorDt = _dt;
+  m_factorParticles = numParticles;
+  m_factorSprings = _springs.size();
+  ++m_numFactorisations;
+}
+
+void ProjectiveSolver::project(const SpringStore &_springs, std::size_t _begin, std::size_t _end)
+{
+  for (std::size_t i = _begin; i < _end; ++i)
+  {
+    //the closest vector to the current one with the rest length
+    glm::vec3 direction = m_positions[_springs.getPointB(i)] - m_positions[_springs.getPointA(i)];
+    float springLength = glm::length(direction);
+    if (springLength > 0.0f)
+    {
+      m_projections[i] = direction * (_springs.getRestLength(i) / springLength);
+    }
+    else
+    {
+      m_projections[i] = glm::vec3(0.0f);
+    }
+  }
+}
@@ -0,0 +1,544 @@
+#include "SimdKernels.h"
+#include "TaskScheduler.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define SIMD_X86
+  #include <immintrin.h>
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+  #else
+    #include <cpuid.h>
+  #endif
+#endif
+
+//each kernel is compiled for its own instruction set so one binary can run on every host
+#if defined(__GNUC__) || defined(__clang__)
+  #define SIMD_TARGET(_isa) __attribute__((target(_isa)))
+#else
+  #define SIMD_TARGET(_isa)
+#endif
+
+namespace SimdKernels
+{
+  namespace
+  {
+    ///A structure for the spring force kernel function and the integration kernel function of one instruction set.
+    struct KernelTable
+    {
+      ///The instruction set of the kernels.
+      Isa m_isa;
+      ///The spring force kernel.
+      void (*m_springForces)(const SpringStore &, ParticleStore &, std::size_t, std::size_t);
+      ///The integration kernel.
+      void (*m_integrate)(ParticleStore &, glm::vec3, float, std::size_t, std::size_t);
+    };
+
+    void springForcesScalar(const SpringStore &_springs, ParticleStore &_particles, std::size_t _begin, std::size_t _end)
+    {
+      _springs.computeForces(_particles, _begin, _end);
+    }
+
+    void integrateScalar(ParticleStore &_particles, glm::vec3 _externalForce, float _dt, std::size_t _begin, std::size_t _end)
+    {
+      _particles.integrate(_externalForce, _dt, _begin, _end);
+    }
+
+#ifdef SIMD_X86
+    /**
+    @brief Adds a block of computed spring forces and the endpoint damping to the particle force accumulators.
+    This stays scalar as springs in the same block can share a particle.
+    */
+    inline void scatterSpringForces(const std::uint32_t *_pointA, const std::uint32_t *_pointB,
+                                    const float *_fx, const float *_fy, const float *_fz, int _count,
+                                    float _damping, ParticleStore &_particles)
+    {
+      const float *velX = _particles.getVelX();
+      const float *velY = _particles.getVelY();
+      const float *velZ = _particles.getVelZ();
+      float *forceX = _particles.getForceX();
+      float *forceY = _particles.getForceY();
+      float *forceZ = _particles.getForceZ();
+
+      for (int j = 0; j < _count; ++j)
+      {
+        std::uint32_t a = _pointA[j];
+        std::uint32_t b = _pointB[j];
+        forceX[a] += -_fx[j] - (_damping * velX[a]);
+        forceY[a] += -_fy[j] - (_damping * velY[a]);
+        forceZ[a] += -_fz[j] - (_damping * velZ[a]);
+        forceX[b] += _fx[j] - (_damping * velX[b]);
+        forceY[b] += _fy[j] - (_damping * velY[b]);
+        forceZ[b] += _fz[j] - (_damping * velZ[b]);
+      }
+    }
+
+    /*SSE2 KERNELS********************************************************************/
+    SIMD_TARGET("sse2") inline __m128 gather4(const float *_base, const std::uint32_t *_index)
+    {
+      return _mm_set_ps(_base[_index[3]], _base[_index[2]], _base[_index[1]], _base[_index[0]]);
+    }
+
+    SIMD_TARGET("sse2") inline __m128 gatherMaterial4(const float *_table, const std::uint8_t *_material)
+    {
+      return _mm_set_ps(_table[_material[3]], _table[_material[2]], _table[_material[1]], _table[_material[0]]);
+    }
+
+    SIMD_TARGET("sse2") void springForcesSSE2(const SpringStore &_springs, ParticleStore &_particles, std::size_t _begin, std::size_t _end)
+    {
+      const std::uint32_t *pointA = _springs.getPointsA();
+      const std::uint32_t *pointB = _springs.getPointsB();
+      const std::uint8_t *materials = _springs.getMaterials();
+      const float *stiffness = _springs.getMaterialStiffnesses();
+      const float *restLength = _springs.getMaterialRestLengths();
+      const float *posX = _particles.getPosX();
+      const float *posY = _particles.getPosY();
+      const float *posZ = _particles.getPosZ();
+      alignas(16) float fx[4];
+      alignas(16) float fy[4];
+      alignas(16) float fz[4];
+
+      std::size_t i = _begin;
+      for (; i + 4 <= _end; i += 4)
+      {
+        //the vector from point a to point b
+        __m128 dx = _mm_sub_ps(gather4(posX, pointB + i), gather4(posX, pointA + i));
+        __m128 dy = _mm_sub_ps(gather4(posY, pointB + i), gather4(posY, pointA + i));
+        __m128 dz = _mm_sub_ps(gather4(posZ, pointB + i), gather4(posZ, pointA + i));
+
+        //one square root gives both the length and the normalised direction
+        __m128 springLength = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+        __m128 magnitude = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), gatherMaterial4(stiffness, materials + i)),
+                                      _mm_sub_ps(springLength, gatherMaterial4(restLength, materials + i)));
+        __m128 scale = _mm_div_ps(magnitude, springLength);
+
+        _mm_store_ps(fx, _mm_mul_ps(dx, scale));
+        _mm_store_ps(fy, _mm_mul_ps(dy, scale));
+        _mm_store_ps(fz, _mm_mul_ps(dz, scale));
+        scatterSpringForces(pointA + i, pointB + i, fx, fy, fz, 4, _springs.getDamping(), _particles);
+      }
+
+      //finish off the remaining springs
+      _springs.computeForces(_particles, i, _end);
+    }
+
+    SIMD_TARGET("sse2") void integrateSSE2(ParticleStore &_particles, glm::vec3 _externalForce, float _dt, std::size_t _begin, std::size_t _end)
+    {
+      float *posX = _particles.getPosX();
+      float *posY = _particles.getPosY();
+      float *posZ = _particles.getPosZ();
+      float *velX = _particles.getVelX();
+      float *velY = _particles.getVelY();
+      float *velZ = _particles.getVelZ();
+      const float *forceX = _particles.getForceX();
+      const float *forceY = _particles.getForceY();
+      const float *forceZ = _particles.getForceZ();
+      const float *invMass = _particles.getInvMass();
+      const std::uint8_t *locked = _particles.getLocked();
+
+      __m128 dt = _mm_set1_ps(_dt);
+      __m128 externalX = _mm_set1_ps(_externalForce.x);
+      __m128 externalY = _mm_set1_ps(_externalForce.y);
+      __m128 externalZ = _mm_set1_ps(_externalForce.z);
+      __m128i zero = _mm_setzero_si128();
+
+      std::size_t i = _begin;
+      for (; i + 4 <= _end; i += 4)
+      {
+        //widen the 4 locked flags into a mask that is set for the unlocked particles
+        std::int32_t lockedBytes;
+        std::memcpy(&lockedBytes, locked + i, sizeof(lockedBytes));
+        __m128i lockedFlags = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(lockedBytes), zero), zero);
+        __m128 unlocked = _mm_castsi128_ps(_mm_cmpeq_epi32(lockedFlags, zero));
+
+        __m128 w = _mm_loadu_ps(invMass + i);
+        __m128 vx = _mm_loadu_ps(velX + i);
+        __m128 vy = _mm_loadu_ps(velY + i);
+        __m128 vz = _mm_loadu_ps(velZ + i);
+        __m128 px = _mm_loadu_ps(posX + i);
+        __m128 py = _mm_loadu_ps(posY + i);
+        __m128 pz = _mm_loadu_ps(posZ + i);
+
+        //calculate the velocity and then the position of the points
+        __m128 newVX = _mm_add_ps(vx, _mm_mul_ps(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(forceX + i), externalX), w), dt));
+        __m128 newVY = _mm_add_ps(vy, _mm_mul_ps(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(forceY + i), externalY), w), dt));
+        __m128 newVZ = _mm_add_ps(vz, _mm_mul_ps(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(forceZ + i), externalZ), w), dt));
+        __m128 newPX = _mm_add_ps(px, _mm_mul_ps(newVX, dt));
+        __m128 newPY = _mm_add_ps(py, _mm_mul_ps(newVY, dt));
+        __m128 newPZ = _mm_add_ps(pz, _mm_mul_ps(newVZ, dt));
+
+        //only keep the new values of the unlocked points
+        _mm_storeu_ps(velX + i, _mm_or_ps(_mm_and_ps(unlocked, newVX), _mm_andnot_ps(unlocked, vx)));
+        _mm_storeu_ps(velY + i, _mm_or_ps(_mm_and_ps(unlocked, newVY), _mm_andnot_ps(unlocked, vy)));
+        _mm_storeu_ps(velZ + i, _mm_or_ps(_mm_and_ps(unlocked, newVZ), _mm_andnot_ps(unlocked, vz)));
+        _mm_storeu_ps(posX + i, _mm_or_ps(_mm_and_ps(unlocked, newPX), _mm_andnot_ps(unlocked, px)));
+        _mm_storeu_ps(posY + i, _mm_or_ps(_mm_and_ps(unlocked, newPY), _mm_andnot_ps(unlocked, py)));
+        _mm_storeu_ps(posZ + i, _mm_or_ps(_mm_and_ps(unlocked, newPZ), _mm_andnot_ps(unlocked, pz)));
+      }
+
+      //finish off the remaining points
+      _particles.integrate(_externalForce, _dt, i, _end);
+    }
+
+    /*AVX2 KERNELS********************************************************************/
+    SIMD_TARGET("avx2") void springForcesAVX2(const SpringStore &_springs, ParticleStore &_particles, std::size_t _begin, std::size_t _end)
+    {
+      const std::uint32_t *pointA = _springs.getPointsA();
+      const std::uint32_t *pointB = _springs.getPointsB();
+      const std::uint8_t *materials = _springs.getMaterials();
+      const float *stiffness = _springs.getMaterialStiffnesses();
+      const float *restLength = _springs.getMaterialRestLengths();
+      const float *posX = _particles.getPosX();
+      const float *posY = _particles.getPosY();
+      const float *posZ = _particles.getPosZ();
+      alignas(32) float fx[8];
+      alignas(32) float fy[8];
+      alignas(32) float fz[8];
+
+      std::size_t i = _begin;
+      for (; i + 8 <= _end; i += 8)
+      {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pointA + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pointB + i));
+        //widen the 8 material indices to look the springs up in the material table
+        __m256i material = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(materials + i)));
+
+        //the vector from point a to point b
+        __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(posX, b, 4), _mm256_i32gather_ps(posX, a, 4));
+        __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(posY, b, 4), _mm256_i32gather_ps(posY, a, 4));
+        __m256 dz = _mm256_sub_ps(_mm256_i32gather_ps(posZ, b, 4), _mm256_i32gather_ps(posZ, a, 4));
+
+        //one square root gives both the length and the normalised direction
+        __m256 springLength = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz)));
+        __m256 magnitude = _mm256_mul_ps(_mm256_sub_ps(_mm256_setzero_ps(), _mm256_i32gather_ps(stiffness, material, 4)),
+                                         _mm256_sub_ps(springLength, _mm256_i32gather_ps(restLength, material, 4)));
+        __m256 scale = _mm256_div_ps(magnitude, springLength);
+
+        _mm256_store_ps(fx, _mm256_mul_ps(dx, scale));
+        _mm256_store_ps(fy, _mm256_mul_ps(dy, scale));
+        _mm256_store_ps(fz, _mm256_mul_ps(dz, scale));
+        scatterSpringForces(pointA + i, pointB + i, fx, fy, fz, 8, _springs.getDamping(), _particles);
+      }
+
+      //finish off the remaining springs
+      _springs.computeForces(_particles, i, _end);
+    }
+
+    SIMD_TARGET("avx2") void integrateAVX2(ParticleStore &_particles, glm::vec3 _externalForce, float _dt, std::size_t _begin, std::size_t _end)
+    {
+      float *posX = _particles.getPosX();
+      float *posY = _particles.getPosY();
+      float *posZ = _particles.getPosZ();
+      float *velX = _particles.getVelX();
+      float *velY = _particles.getVelY();
+      float *velZ = _particles.getVelZ();
+      const float *forceX = _particles.getForceX();
+      const float *forceY = _particles.getForceY();
+      const float *forceZ = _particles.getForceZ();
+      const float *invMass = _particles.getInvMass();
+      const std::uint8_t *locked = _particles.getLocked();
+
+      __m256 dt = _mm256_set1_ps(_dt);
+      __m256 externalX = _mm256_set1_ps(_externalForce.x);
+      __m256 externalY = _mm256_set1_ps(_externalForce.y);
+      __m256 externalZ = _mm256_set1_ps(_externalForce.z);
+
+      std::size_t i = _begin;
+      for (; i + 8 <= _end; i += 8)
+      {
+        //widen the 8 locked flags into a mask that is set for the unlocked particles
+        __m256i lockedFlags = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(locked + i)));
+        __m256 unlocked = _mm256_castsi256_ps(_mm256_cmpeq_epi32(lockedFlags, _mm256_setzero_si256()));
+
+        __m256 w = _mm256_loadu_ps(invMass + i);
+        __m256 vx = _mm256_loadu_ps(velX + i);
+        __m256 vy = _mm256_loadu_ps(velY + i);
+        __m256 vz = _mm256_loadu_ps(velZ + i);
+        __m256 px = _mm256_loadu_ps(posX + i);
+        __m256 py = _mm256_loadu_ps(posY + i);
+        __m256 pz = _mm256_loadu_ps(posZ + i);
+
+        //calculate the velocity and then the position of the points
+        __m256 newVX = _mm256_add_ps(vx, _mm256_mul_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(forceX + i), externalX), w), dt));
+        __m256 newVY = _mm256_add_ps(vy, _mm256_mul_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(forceY + i), externalY), w), dt));
+        __m256 newVZ = _mm256_add_ps(vz, _mm256_mul_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(forceZ + i), externalZ), w), dt));
+
+        //only keep the new values of the unlocked points
+        newVX = _mm256_blendv_ps(vx, newVX, unlocked);
+        newVY = _mm256_blendv_ps(vy, newVY, unlocked);
+        newVZ = _mm256_blendv_ps(vz, newVZ, unlocked);
+        _mm256_storeu_ps(velX + i, newVX);
+        _mm256_storeu_ps(velY + i, newVY);
+        _mm256_storeu_ps(velZ + i, newVZ);
+        _mm256_storeu_ps(posX + i, _mm256_blendv_ps(px, _mm256_add_ps(px, _mm256_mul_ps(newVX, dt)), unlocked));
+        _mm256_storeu_ps(posY + i, _mm256_blendv_ps(py, _mm256_add_ps(py, _mm256_mul_ps(newVY, dt)), unlocked));
+        _mm256_storeu_ps(posZ + i, _mm256_blendv_ps(pz, _mm256_add_ps(pz, _mm256_mul_ps(newVZ, dt)), unlocked));
+      }
+
+      //finish off the remaining points
+      _particles.integrate(_externalForce, _dt, i, _end);
+    }
+
+    /*AVX-512 KERNELS*****************************************************************/
+    SIMD_TARGET("avx512f") void springForcesAVX512(const SpringStore &_springs, ParticleStore &_particles, std::size_t _begin, std::size_t _end)
+    {
+      const std::uint32_t *pointA = _springs.getPointsA();
+      const std::uint32_t *pointB = _springs.getPointsB();
+      const std::uint8_t *materials = _springs.getMaterials();
+      const float *stiffness = _springs.getMaterialStiffnesses();
+      const float *restLength = _springs.getMaterialRestLengths();
+      const float *posX = _particles.getPosX();
+      const float *posY = _particles.getPosY();
+      const float *posZ = _particles.getPosZ();
+      alignas(64) float fx[16];
+      alignas(64) float fy[16];
+      alignas(64) float fz[16];
+
+      std::size_t i = _begin;
+      for (; i + 16 <= _end; i += 16)
+      {
+        __m512i a = _mm512_loadu_si512(pointA + i);
+        __m512i b = _mm512_loadu_si512(pointB + i);
+        //widen the 16 material indices to look the springs up in the material table
+        __m512i material = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(materials + i)));
+
+        //the vector from point a to point b
+        __m512 dx = _mm512_sub_ps(_mm512_i32gather_ps(b, posX, 4), _mm512_i32gather_ps(a, posX, 4));
+        __m512 dy = _mm512_sub_ps(_mm512_i32gather_ps(b, posY, 4), _mm512_i32gather_ps(a, posY, 4));
+        __m512 dz = _mm512_sub_ps(_mm512_i32gather_ps(b, posZ, 4), _mm512_i32gather_ps(a, posZ, 4));
+
+        //one square root gives both the length and the normalised direction
+        __m512 springLength = _mm512_sqrt_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)), _mm512_mul_ps(dz, dz)));
+        __m512 magnitude = _mm512_mul_ps(_mm512_sub_ps(_mm512_setzero_ps(), _mm512_i32gather_ps(material, stiffness, 4)),
+                                         _mm512_sub_ps(springLength, _mm512_i32gather_ps(material, restLength, 4)));
+        __m512 scale = _mm512_div_ps(magnitude, springLength);
+
+        _mm512_store_ps(fx, _mm512_mul_ps(dx, scale));
+        _mm512_store_ps(fy, _mm512_mul_ps(dy, scale));
+        _mm512_store_ps(fz, _mm512_mul_ps(dz, scale));
+        scatterSpringForces(pointA + i, pointB + i, fx, fy, fz, 16, _springs.getDamping(), _particles);
+      }
+
+      //finish off the remaining springs
+      _springs.computeForces(_particles, i, _end);
+    }
+
+    SIMD_TARGET("avx512f") void integrateAVX512(ParticleStore &_particles, glm::vec3 _externalForce, float _dt, std::size_t _begin, std::size_t _end)
+    {
+      float *posX = _particles.getPosX();
+      float *posY = _particles.getPosY();
+      float *posZ = _particles.getPosZ();
+      float *velX = _particles.getVelX();
+      float *velY = _particles.getVelY();
+      float *velZ = _particles.getVelZ();
+      const float *forceX = _particles.getForceX();
+      const float *forceY = _particles.getForceY();
+      const float *forceZ = _particles.getForceZ();
+      const float *invMass = _particles.getInvMass();
+      const std::uint8_t *locked = _particles.getLocked();
+
+      __m512 dt = _mm512_set1_ps(_dt);
+      __m512 externalX = _mm512_set1_ps(_externalForce.x);
+      __m512 externalY = _mm512_set1_ps(_externalForce.y);
+      __m512 externalZ = _mm512_set1_ps(_externalForce.z);
+
+      std::size_t i = _begin;
+      for (; i + 16 <= _end; i += 16)
+      {
+        //widen the 16 locked flags into a mask that is set for the unlocked particles
+        __m512i lockedFlags = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(locked + i)));
+        __mmask16 unlocked = _mm512_testn_epi32_mask(lockedFlags, lockedFlags);
+
+        __m512 w = _mm512_loadu_ps(invMass + i);
+
+        //calculate the velocity and then the position of the points
+        __m512 vx = _mm512_add_ps(_mm512_loadu_ps(velX + i), _mm512_mul_ps(_mm512_mul_ps(_mm512_add_ps(_mm512_loadu_ps(forceX + i), externalX), w), dt));
+        __m512 vy = _mm512_add_ps(_mm512_loadu_ps(velY + i), _mm512_mul_ps(_mm512_mul_ps(_mm512_add_ps(_mm512_loadu_ps(forceY + i), externalY), w), dt));
+        __m512 vz = _mm512_add_ps(_mm512_loadu_ps(velZ + i), _mm512_mul_ps(_mm512_mul_ps(_mm512_add_ps(_mm512_loadu_ps(forceZ + i), externalZ), w), dt));
+
+        //only write the new values of the unlocked points
+        _mm512_mask_storeu_ps(velX + i, unlocked, vx);
+        _mm512_mask_storeu_ps(velY + i, unlocked, vy);
+        _mm512_mask_storeu_ps(velZ + i, unlocked, vz);
+        _mm512_mask_storeu_ps(posX + i, unlocked, _mm512_add_ps(_mm512_loadu_ps(posX + i), _mm512_mul_ps(vx, dt)));
+        _mm512_mask_storeu_ps(posY + i, unlocked, _mm512_add_ps(_mm512_loadu_ps(posY + i), _mm512_mul_ps(vy, dt)));
+        _mm512_mask_storeu_ps(posZ + i, unlocked, _mm512_add_ps(_mm512_loadu_ps(posZ + i), _mm512_mul_ps(vz, dt)));
+      }
+
+      //finish off the remaining points
+      _particles.integrate(_externalForce, _dt, i, _end);
+    }
+
+    /*CPU DETECTION*******************************************************************/
+    void cpuid(unsigned int _registers[4], unsigned int _leaf, unsigned int _subLeaf)
+    {
+  #if defined(_MSC_VER)
+      int registers[4];
+      __cpuidex(registers, int(_leaf), int(_subLeaf));
+      for (int i = 0; i < 4; ++i)
+      {
+        _registers[i] = unsigned(registers[i]);
+      }
+  #else
+      __cpuid_count(_leaf, _subLeaf, _registers[0], _registers[1], _registers[2], _registers[3]);
+  #endif
+    }
+
+    unsigned long long getEnabledStates()
+    {
+  #if defined(_MSC_VER)
+      return _xgetbv(0);
+  #else
+      unsigned int low;
+      unsigned int high;
+      __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+      return (static_cast<unsigned long long>(high) << 32) | low;
+  #endif
+    }
+#endif // SIMD_X86
+
+    Isa detectIsa()
+    {
+      Isa isa = Isa::SCALAR;
+#ifdef SIMD_X86
+      unsigned int registers[4];
+      cpuid(registers, 0, 0);
+      unsigned int maxLeaf = registers[0];
+
+      cpuid(registers, 1, 0);
+      //edx bit 26 is SSE2
+      if (registers[3] & (1u << 26))
+      {
+        isa = Isa::SSE2;
+      }
+
+      //ecx bit 27 is OSXSAVE, the OS has to save the AVX registers before they can be used
+      bool osxsave = (registers[2] & (1u << 27)) != 0;
+      if (!osxsave || maxLeaf < 7)
+      {
+        return isa;
+      }
+
+      unsigned long long states = getEnabledStates();
+      bool avxStates = (states & 0x6) == 0x6;
+      bool avx512States = (states & 0xE6) == 0xE6;
+
+      cpuid(registers, 7, 0);
+      //ebx bit 5 is AVX2 and bit 16 is AVX512F
+      if (avxStates && (registers[1] & (1u << 5)))
+      {
+        isa = Isa::AVX2;
+      }
+      if (avx512States && (registers[1] & (1u << 16)))
+      {
+        isa = Isa::AVX512;
+      }
+#endif
+      return isa;
+    }
+
+    KernelTable getKernelTable(Isa _isa)
+    {
+      switch (_isa)
+      {
+#ifdef SIMD_X86
+        case Isa::AVX512:
+          return {Isa::AVX512, springForcesAVX512, integrateAVX512};
+        case Isa::AVX2:
+          return {Isa::AVX2, springForcesAVX2, integrateAVX2};
+        case Isa::SSE2:
+          return {Isa::SSE2, springForcesSSE2, integrateSSE2};
+#endif
+        default:
+          return {Isa::SCALAR, springForcesScalar, integrateScalar};
+      }
+    }
+
+    KernelTable &getSelectedKernels()
+    {
+      //picked once, the first time a kernel is used
+      static KernelTable kernels = getKernelTable(getDetectedIsa());
+      return kernels;
+    }
+  }
+
+  Isa getDetectedIsa()
+  {
+    static Isa detectedIsa = detectIsa();
+    return detectedIsa;
+  }
+
+  Isa getIsa()
+  {
+    return getSelectedKernels().m_isa;
+  }
+
+  void setIsa(Isa _isa)
+  {
+    if (_isa > getDetectedIsa())
+    {
+      _isa = getDetectedIsa();
+    }
+    getSelectedKernels() = getKernelTable(_isa);
+  }
+
+  std::string isaToString(Isa _isa)
+  {
+    switch (_isa)
+    {
+      case Isa::AVX512:
+        return "AVX-512";
+      case Isa::AVX2:
+        return "AVX2";
+      case Isa::SSE2:
+        return "SSE2";
+      default:
+        return "Scalar";
+    }
+  }
+
+  void computeSpringForces(const SpringStore &_springs, ParticleStore &_particles, std::size_t _begin, std::size_t _end)
+  {
+    getSelectedKernels().m_springForces(_springs, _particles, _begin, _end);
+  }
+
+  void integrate(ParticleStore &_particles, glm::vec3 _externalForce, float _dt, std::size_t _begin, std::size_t _end)
+  {
+    getSelectedKernels().m_integrate(_particles, _externalForce, _dt, _begin, _end);
+  }
+
+  void computeSpringForcesParallel(const SpringStore &_springs, ParticleStore &_particles)
+  {
+    if (_springs.size() < c_parallelThreshold || _springs.getNumColours() == 0)
+    {
+      computeSpringForces(_springs, _particles, 0, _springs.size());
+      return;
+    }
+
+    //the batches run one after the other, the springs within a batch are split across the threads
+    for (std::size_t colour = 0; colour < _springs.getNumColours(); ++colour)
+    {
+      TaskScheduler::instance().parallelFor(_springs.getColourBegin(colour), _springs.getColourEnd(colour), c_parallelGrainSize,
+                                            [&_springs, &_particles](std::size_t _chunkBegin, std::size_t _chunkEnd)
+      {
+        computeSpringForces(_springs, _particles, _chunkBegin, _chunkEnd);
+      });
+    }
+  }
+
+  void integrateParallel(ParticleStore &_particles, glm::vec3 _externalForce, float _dt, std::size_t _begin, std::size_t _end)
+  {
+    if (_end - _begin < c_parallelThreshold)
+    {
+      integrate(_particles, _externalForce, _dt, _begin, _end);
+      return;
+    }
+
+    TaskScheduler::instance().parallelFor(_begin, _end, c_parallelGrainSize,
+                                          [&_particles, _externalForce, _dt](std::size_t _chunkBegin, std::size_t _chunkEnd)
+    {
+      integrate(_particles, _externalForce, _dt, _chunkBegin, _chunkEnd);
+    });
+  }
+}
@@ -0,0 +1,514 @@
+#include "Simulation.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+Simulation::Simulation(unsigned int _gridSize) : m_gridSize(_gridSize), m_numOfObjects(0), m_batched(false), m_batchDirty(true),
+  m_solverType(SolverType::EXPLICIT), m_integratorType(IntegratorType::SYMPLECTIC_EULER), m_doublePrecision(false),
+  m_blockedSubsteps(false), m_topology(SpringTopology::STRUCTURAL), m_particleOrder(ParticleOrder::ROW_MAJOR), m_baseStiffness(1.0f),
+  m_numSubsteps(1), m_commands(256), m_running(false)
+{
+  buildFlames(0);
+}
+
+Simulation::~Simulation()
+{
+  stop();
+}
+
+void Simulation::start()
+{
+  if (m_running.exchange(true))
+  {
+    return;
+  }
+  m_thread = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop()
+{
+  m_running = false;
+  if (m_thread.joinable())
+  {
+    m_thread.join();
+  }
+}
+
+bool Simulation::isRunning() const
+{
+  return m_running;
+}
+
+void Simulation::step(float _frameTime)
+{
+  //the settings changed since the last pass all land before this one
+  applyCommands();
+
+  //the simulation runs at a fixed rate whatever the frame rate is, this pass takes the steps its time covers
+  unsigned int numSteps = m_stepClock.advance(_frameTime);
+  float stepSize = m_stepClock.getStepSize();
+  //the flames are drawn part way between the last two steps by the time left over
+  float alpha = m_stepClock.getAlpha();
+
+  if (m_batched)
+  {
+    //pack the flames again if they have changed since the last step
+    if (m_batchDirty)
+    {
+      m_flameBatch.build(m_massSpringObjects);
+      m_batchDirty = false;
+    }
+
+    //step every flame in one pass over the shared buffers
+    for (unsigned int i = 0; i < numSteps; ++i)
+    {
+      m_flameBatch.update(stepSize);
+    }
+    m_numSubsteps = m_flameBatch.getNumSubsteps();
+  }
+  else
+  {
+    //mass spring, the flames are independent so they are stepped across the threads one flame at a time so different
+    //grid sizes balance out
+    TaskScheduler::instance().parallelFor(0, m_massSpringObjects.size(), 1,
+                                          [this, numSteps, stepSize](std::size_t _begin, std::size_t _end)
+    {
+      for (std::size_t i = _begin; i < _end; ++i)
+      {
+        //update the mass spring point
+        for (unsigned int j = 0; j < numSteps; ++j)
+        {
+          m_massSpringObjects[i]->update(stepSize);
+        }
+      }
+    });
+
+    m_numSubsteps = 1;
+    for (auto massSpringObj : m_massSpringObjects)
+    {
+      m_numSubsteps = std::max(m_numSubsteps, massSpringObj->getNumSubsteps());
+    }
+  }
+
+  publishSnapshot(alpha);
+}
+
+bool Simulation::updateSnapshot()
+{
+  return m_snapshots.update();
+}
+
+const FrameSnapshot &Simulation::getSnapshot() const
+{
+  return m_snapshots.getReadBuffer();
+}
+
+void Simulation::generateFlames(int _numOfObjects)
+{
+  SimulationCommand command = {SimulationCommandType::GENERATE_FLAMES, 0.0f, _numOfObjects, 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setGridSize(unsigned int _gridSize)
+{
+  SimulationCommand command = {SimulationCommandType::GRID_SIZE, 0.0f, int(_gridSize), 0, false};
+  pushCommand(command);
+}
+
+void Simulation::restart()
+{
+  SimulationCommand command = {SimulationCommandType::RESTART, 0.0f, 0, 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setBuoyancy(float _buoyancy)
+{
+  SimulationCommand command = {SimulationCommandType::BUOYANCY, _buoyancy, 0, 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setWindImpulseOn(float _impulseOnTime)
+{
+  SimulationCommand command = {SimulationCommandType::WIND_IMPULSE_ON, _impulseOnTime, 0, 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setWindImpulseOff(float _impulseOffTime)
+{
+  SimulationCommand command = {SimulationCommandType::WIND_IMPULSE_OFF, _impulseOffTime, 0, 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setWindForce(char _axis, float _windForce)
+{
+  SimulationCommand command = {SimulationCommandType::WIND_FORCE, _windForce, 0, _axis, false};
+  pushCommand(command);
+}
+
+void Simulation::setMass(float _mass)
+{
+  SimulationCommand command = {SimulationCommandType::MASS, _mass, 0, 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setSpringConstant(float _springConstant)
+{
+  SimulationCommand command = {SimulationCommandType::SPRING_CONSTANT, _springConstant, 0, 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setDamping(float _damping)
+{
+  SimulationCommand command = {SimulationCommandType::DAMPING, _damping, 0, 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setRestLength(float _restLength)
+{
+  SimulationCommand command = {SimulationCommandType::REST_LENGTH, _restLength, 0, 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setBaseStiffness(float _baseStiffness)
+{
+  SimulationCommand command = {SimulationCommandType::BASE_STIFFNESS, _baseStiffness, 0, 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setTopology(SpringTopology _topology)
+{
+  SimulationCommand command = {SimulationCommandType::TOPOLOGY, 0.0f, int(_topology), 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setParticleOrder(ParticleOrder _order)
+{
+  SimulationCommand command = {SimulationCommandType::PARTICLE_ORDER, 0.0f, int(_order), 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setNumThreads(unsigned int _numThreads)
+{
+  //the workers cannot be changed while a pass is using them so this is queued like the other settings
+  SimulationCommand command = {SimulationCommandType::NUM_THREADS, 0.0f, int(_numThreads), 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setBatched(bool _batched)
+{
+  SimulationCommand command = {SimulationCommandType::BATCHED, 0.0f, 0, 0, _batched};
+  pushCommand(command);
+}
+
+void Simulation::setSolverType(SolverType _solverType)
+{
+  SimulationCommand command = {SimulationCommandType::SOLVER_TYPE, 0.0f, int(_solverType), 0, false};
+  pushCommand(command);
+}
+
+void Simulation::setIntegrator(IntegratorType _integratorType, bool _doublePrecision)
+{
+  SimulationCommand command = {SimulationCommandType::INTEGRATOR, 0.0f, int(_integratorType), 0, _doublePrecision};
+  pushCommand(command);
+}
+
+void Simulation::setBlockedSubsteps(bool _blockedSubsteps)
+{
+  SimulationCommand command = {SimulationCommandType::BLOCKED_SUBSTEPS, 0.0f, 0, 0, _blockedSubsteps};
+  pushCommand(command);
+}
+
+void Simulation::run()
+{
+  Timer timer;
+  timer.timerStart();
+  while (m_running)
+  {
+    //stop the timer and get the time since the last pass
+    float frameTime = float(timer.timerFinish());
+    timer.timerStart();
+
+    step(frameTime);
+
+    //the pass runs at the same 1ms rate the frame timer did
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void Simulation::pushCommand(const SimulationCommand &_command)
+{
+  //the queue only fills if the simulation thread is stuck in a long pass, wait for it to make room
+  while (!m_commands.push(_command))
+  {
+    std::this_thread::yield();
+  }
+
+  //with no simulation thread the caller is the only thread touching the flames
+  if (!m_running)
+  {
+    applyCommands();
+  }
+}
+
+void Simulation::applyCommands()
+{
+  SimulationCommand command;
+  while (m_commands.pop(command))
+  {
+    applyCommand(command);
+  }
+}
+
+void Simulation::applyCommand(const SimulationCommand &_command)
+{
+  switch (_command.m_type)
+  {
+    case SimulationCommandType::GENERATE_FLAMES:
+      buildFlames(_command.m_intValue);
+      break;
+    case SimulationCommandType::GRID_SIZE:
+      m_gridSize = unsigned(std::max(_command.m_intValue, 2));
+      buildFlames(m_numOfObjects);
+      m_stepClock.reset();
+      break;
+    case SimulationCommandType::RESTART:
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->reset();
+      }
+      m_batchDirty = true;
+      m_stepClock.reset();
+      //the reset flames have no step to draw across
+      publishSnapshot(1.0f);
+      break;
+    case SimulationCommandType::BUOYANCY:
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setBoyancy(_command.m_value);
+      }
+      break;
+    case SimulationCommandType::WIND_IMPULSE_ON:
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setImpulseOnTime(_command.m_value);
+      }
+      break;
+    case SimulationCommandType::WIND_IMPULSE_OFF:
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setImpulseOffTime(_command.m_value);
+      }
+      break;
+    case SimulationCommandType::WIND_FORCE:
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setWindForce(_command.m_axis, _command.m_value);
+      }
+      break;
+    case SimulationCommandType::MASS:
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setMass(_command.m_value);
+      }
+      m_flameBatch.setMass(_command.m_value);
+      break;
+    case SimulationCommandType::SPRING_CONSTANT:
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setSpringConstant(_command.m_value);
+      }
+      m_flameBatch.setSpringConstant(_command.m_value);
+      break;
+    case SimulationCommandType::DAMPING:
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setDamping(_command.m_value);
+      }
+      m_flameBatch.setDamping(_command.m_value);
+      break;
+    case SimulationCommandType::REST_LENGTH:
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setRestLength(_command.m_value);
+      }
+      m_flameBatch.setRestLength(_command.m_value);
+      break;
+    case SimulationCommandType::BASE_STIFFNESS:
+      m_baseStiffness = _command.m_value;
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setBaseStiffness(_command.m_value);
+      }
+      m_flameBatch.setBaseStiffness(_command.m_value);
+      break;
+    case SimulationCommandType::TOPOLOGY:
+      if (m_batched && !m_flameBatch.isEmpty())
+      {
+        //the batch packs the new springs when it is built again, so it hands its state back first
+        m_flameBatch.writeBack();
+      }
+      m_topology = SpringTopology(_command.m_intValue);
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setTopology(m_topology);
+      }
+      m_batchDirty = true;
+      break;
+    case SimulationCommandType::PARTICLE_ORDER:
+      if (m_batched && !m_flameBatch.isEmpty())
+      {
+        //the flames move their particles so the batch hands its state back and packs them again
+        m_flameBatch.writeBack();
+      }
+      m_particleOrder = ParticleOrder(_command.m_intValue);
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setParticleOrder(m_particleOrder);
+      }
+      m_batchDirty = true;
+      break;
+    case SimulationCommandType::NUM_THREADS:
+      TaskScheduler::instance().setNumThreads(unsigned(_command.m_intValue));
+      break;
+    case SimulationCommandType::BATCHED:
+      if (m_batched && !_command.m_flag)
+      {
+        //hand the state back so the flames carry on from where the batch left them
+        m_flameBatch.writeBack();
+        m_flameBatch.clear();
+      }
+      m_batched = _command.m_flag;
+      m_batchDirty = true;
+      break;
+    case SimulationCommandType::SOLVER_TYPE:
+    {
+      //the grid stencil keeps the particles in row major order so the flames move them when it is picked or left
+      SolverType solverType = SolverType(_command.m_intValue);
+      bool reorder = m_particleOrder != ParticleOrder::ROW_MAJOR &&
+                     ((m_solverType == SolverType::GRID_STENCIL) != (solverType == SolverType::GRID_STENCIL));
+      if (reorder && m_batched && !m_flameBatch.isEmpty())
+      {
+        m_flameBatch.writeBack();
+      }
+      m_solverType = solverType;
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setSolverType(m_solverType);
+      }
+      m_flameBatch.setSolverType(m_solverType);
+      if (reorder)
+      {
+        m_batchDirty = true;
+      }
+      break;
+    }
+    case SimulationCommandType::INTEGRATOR:
+      m_integratorType = IntegratorType(_command.m_intValue);
+      m_doublePrecision = _command.m_flag;
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setIntegrator(m_integratorType, m_doublePrecision);
+      }
+      m_flameBatch.setIntegrator(m_integratorType, m_doublePrecision);
+      break;
+    case SimulationCommandType::BLOCKED_SUBSTEPS:
+      m_blockedSubsteps = _command.m_flag;
+      for (auto massSpringObj : m_massSpringObjects)
+      {
+        massSpringObj->setBlockedSubsteps(m_blockedSubsteps);
+      }
+      m_flameBatch.setBlockedSubsteps(m_blockedSubsteps);
+      break;
+  }
+}
+
+void Simulation::buildFlames(int _numOfObjects)
+{
+  //empty the flames and the batch sharing them
+  m_massSpringObjects.resize(0);
+  m_flameBatch.clear();
+  m_batchDirty = true;
+  m_numOfObjects = _numOfObjects;
+
+  //the number of mass spring objects.
+  //has to be a perfect square
+  //e.g 1,4,9,16,25,36,49,64,81,100,121,144...
+  int numMassSpringObjects = (_numOfObjects + 1) * (_numOfObjects + 1);
+  //calculate the square root of the number of mass spring objects
+  float sqrtNum = std::sqrt(float(numMassSpringObjects));
+  //calculate the scale of the massSpringObjects, the flames fill the space of the starting grid size whatever theirs is
+  float scale = (float(c_viewGridSize - 1) / float(m_gridSize - 1)) / sqrtNum;
+
+  //generate the mass spring objects
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<> dis(0,7);
+  for (int i = 0; i < numMassSpringObjects; i++)
+  {
+    //initalise the initial mass spring object
+    m_massSpringObjects.push_back(std::shared_ptr<MassSpringObject>(new MassSpringObject(m_gridSize)));
+    m_massSpringObjects.back()->setScale(glm::vec3(scale, scale, scale));
+    m_massSpringObjects.back()->setSolverType(m_solverType);
+    m_massSpringObjects.back()->setIntegrator(m_integratorType, m_doublePrecision);
+    m_massSpringObjects.back()->setBlockedSubsteps(m_blockedSubsteps);
+    m_massSpringObjects.back()->setTopology(m_topology);
+    m_massSpringObjects.back()->setParticleOrder(m_particleOrder);
+    m_massSpringObjects.back()->setBaseStiffness(m_baseStiffness);
+
+    // pick a random texture
+    m_massSpringObjects.back()->setTextureNum(dis(gen));
+  }
+
+  if (numMassSpringObjects > 1)
+  {
+    //move the mass spring objects
+    unsigned long i = 0;
+    float gapWidth = (m_gridSize-1.0f) * scale;
+    float coordTranslation = gapWidth * (sqrtNum * 0.5f) - (gapWidth*0.5f);
+    for (float y = 0; y < sqrtNum; y++)
+    {
+      float currentY = gapWidth * y;
+      for (float x = 0; x < sqrtNum; x++)
+      {
+        float currentX = gapWidth * x;
+        m_massSpringObjects[i]->setPos(glm::vec3(currentX - coordTranslation,currentY - coordTranslation,0.0f));
+        i++;
+      }
+    }
+  }
+
+  //the new flames are drawn before the first step
+  publishSnapshot(1.0f);
+}
+
+void Simulation::publishSnapshot(float _alpha)
+{
+  FrameSnapshot &snapshot = m_snapshots.getWriteBuffer();
+  snapshot.m_flames.resize(m_massSpringObjects.size());
+
+  //every flame writes its own snapshot so they are split across the threads
+  TaskScheduler::instance().parallelFor(0, m_massSpringObjects.size(), 1,
+                                        [this, &snapshot, _alpha](std::size_t _begin, std::size_t _end)
+  {
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      //the snapshots are reused so once they are big enough the positions are blended straight into their memory
+      FlameSnapshot &flame = snapshot.m_flames[i];
+      flame.m_positions.resize(m_massSpringObjects[i]->getVertices().size() * 3);
+      m_massSpringObjects[i]->packPositions(_alpha, flame.m_positions.data());
+      //each snapshot keeps the uv's and indices it was last given, they only change when a flame is generated
+      if (flame.m_meshVersion != m_massSpringObjects[i]->getMeshVersion())
+      {
+        flame.m_uvs = m_massSpringObjects[i]->getUVs();
+        flame.m_indices = m_massSpringObjects[i]->getIndices();
+        flame.m_meshVersion = m_massSpringObjects[i]->getMeshVersion();
+      }
+      flame.m_transform = m_massSpringObjects[i]->getTransform();
+      flame.m_textureNum = m_massSpringObjects[i]->getTextureNum();
+    }
+  });
+  snapshot.m_numSubsteps = m_numSubsteps;
+  m_snapshots.publish();
+}
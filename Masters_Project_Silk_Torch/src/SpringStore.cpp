@@ -0,0 +1,343 @@
+#include "SpringStore.h"
+#include "Logging.h"
+#include <algorithm>
+#include <cmath>
+
+SpringStore::SpringStore() : m_damping(0.1f)
+{
+}
+
+SpringStore::~SpringStore()
+{
+}
+
+void SpringStore::clear()
+{
+  m_pointA.clear();
+  m_pointB.clear();
+  m_material.clear();
+  m_materialStiffness.clear();
+  m_materialRestLength.clear();
+  m_stiffnessRatio.clear();
+  m_restLengthRatio.clear();
+  m_colourOffsets.clear();
+}
+
+void SpringStore::reserve(std::size_t _count)
+{
+  m_pointA.reserve(_count);
+  m_pointB.reserve(_count);
+  m_material.reserve(_count);
+}
+
+std::uint8_t SpringStore::addMaterial(float _stiffness, float _restLength)
+{
+  if (m_materialStiffness.size() == c_maxMaterials)
+  {
+    Logging::logE("Too many spring materials, the extra springs share the last material");
+    return std::uint8_t(c_maxMaterials - 1);
+  }
+  std::size_t material = m_materialStiffness.size();
+  m_materialStiffness.push_back(_stiffness);
+  m_materialRestLength.push_back(_restLength);
+  m_stiffnessRatio.push_back(1.0f);
+  m_restLengthRatio.push_back(1.0f);
+  setMaterialValue(m_materialStiffness, m_stiffnessRatio, material, _stiffness);
+  setMaterialValue(m_materialRestLength, m_restLengthRatio, material, _restLength);
+
+  return std::uint8_t(material);
+}
+
+std::size_t SpringStore::getNumMaterials() const
+{
+  return m_materialStiffness.size();
+}
+
+float SpringStore::getMaterialStiffness(std::uint8_t _material) const
+{
+  return m_materialStiffness[_material];
+}
+
+void SpringStore::setMaterialStiffness(std::uint8_t _material, float _stiffness)
+{
+  setMaterialValue(m_materialStiffness, m_stiffnessRatio, _material, _stiffness);
+}
+
+float SpringStore::getMaterialRestLength(std::uint8_t _material) const
+{
+  return m_materialRestLength[_material];
+}
+
+void SpringStore::setMaterialRestLength(std::uint8_t _material, float _restLength)
+{
+  setMaterialValue(m_materialRestLength, m_restLengthRatio, _material, _restLength);
+}
+
+std::size_t SpringStore::addSpring(std::uint32_t _pointA, std::uint32_t _pointB, std::uint8_t _material)
+{
+  m_pointA.push_back(_pointA);
+  m_pointB.push_back(_pointB);
+  m_material.push_back(_material);
+  m_colourOffsets.clear();
+
+  return m_pointA.size() - 1;
+}
+
+std::size_t SpringStore::addSpring(std::uint32_t _pointA, std::uint32_t _pointB, float _stiffness, float _restLength)
+{
+  return addSpring(_pointA, _pointB, findMaterial(_stiffness, _restLength));
+}
+
+void SpringStore::append(const SpringStore &_other, std::uint32_t _pointOffset)
+{
+  //match the materials of the other springs to the ones here, a material keeps its index when it can so copies of
+  //the same flame line up even when two of their materials have the same values
+  std::vector<std::uint8_t> materials(_other.getNumMaterials());
+  for (std::size_t i = 0; i < materials.size(); ++i)
+  {
+    float stiffness = _other.m_materialStiffness[i];
+    float restLength = _other.m_materialRestLength[i];
+    if (i < m_materialStiffness.size() && m_materialStiffness[i] == stiffness && m_materialRestLength[i] == restLength)
+    {
+      materials[i] = std::uint8_t(i);
+    }
+    else if (i == m_materialStiffness.size())
+    {
+      materials[i] = addMaterial(stiffness, restLength);
+    }
+    else
+    {
+      materials[i] = findMaterial(stiffness, restLength);
+    }
+  }
+
+  for (std::size_t i = 0; i < _other.size(); ++i)
+  {
+    m_pointA.push_back(_other.m_pointA[i] + _pointOffset);
+    m_pointB.push_back(_other.m_pointB[i] + _pointOffset);
+    m_material.push_back(materials[_other.m_material[i]]);
+  }
+  m_colourOffsets.clear();
+}
+
+std::size_t SpringStore::size() const
+{
+  return m_pointA.size();
+}
+
+std::uint32_t SpringStore::getPointA(std::size_t _index) const
+{
+  return m_pointA[_index];
+}
+
+std::uint32_t SpringStore::getPointB(std::size_t _index) const
+{
+  return m_pointB[_index];
+}
+
+std::uint8_t SpringStore::getMaterial(std::size_t _index) const
+{
+  return m_material[_index];
+}
+
+void SpringStore::setMaterial(std::size_t _index, std::uint8_t _material)
+{
+  m_material[_index] = _material;
+}
+
+float SpringStore::getStiffness(std::size_t _index) const
+{
+  return m_materialStiffness[m_material[_index]];
+}
+
+void SpringStore::setStiffness(float _stiffness)
+{
+  scaleMaterials(m_materialStiffness, m_stiffnessRatio, _stiffness);
+}
+
+float SpringStore::getRestLength(std::size_t _index) const
+{
+  return m_materialRestLength[m_material[_index]];
+}
+
+void SpringStore::setRestLength(float _restLength)
+{
+  scaleMaterials(m_materialRestLength, m_restLengthRatio, _restLength);
+}
+
+float SpringStore::getDamping() const
+{
+  return m_damping;
+}
+
+void SpringStore::setDamping(float _damping)
+{
+  m_damping = _damping;
+}
+
+void SpringStore::buildColourBatches()
+{
+  //work out how many particles the springs use
+  std::size_t numParticles = 0;
+  for (std::size_t i = 0; i < m_pointA.size(); ++i)
+  {
+    numParticles = std::max<std::size_t>(numParticles, std::max(m_pointA[i], m_pointB[i]) + 1);
+  }
+
+  //give each spring the lowest colour not already used at either of its points
+  //the grid topologies have at most a dozen springs per particle so 64 colours is plenty
+  std::vector<std::uint64_t> usedColours(numParticles, 0);
+  std::vector<std::uint8_t> colours(m_pointA.size());
+  std::size_t numColours = 0;
+  for (std::size_t i = 0; i < m_pointA.size(); ++i)
+  {
+    std::uint64_t used = usedColours[m_pointA[i]] | usedColours[m_pointB[i]];
+    std::uint8_t colour = 0;
+    while (colour < 64 && (used & (std::uint64_t(1) << colour)))
+    {
+      ++colour;
+    }
+    if (colour == 64)
+    {
+      //a batch of this spring would share a particle with another, so the springs are left uncoloured and the
+      //callers take their serial path
+      Logging::logE("Too many springs share a particle to colour them, the springs are computed serially");
+      m_colourOffsets.clear();
+      return;
+    }
+    colours[i] = colour;
+    usedColours[m_pointA[i]] |= std::uint64_t(1) << colour;
+    usedColours[m_pointB[i]] |= std::uint64_t(1) << colour;
+    numColours = std::max<std::size_t>(numColours, colour + 1u);
+  }
+
+  //count the springs of each colour to get the start of each batch
+  std::vector<std::size_t> offsets(numColours + 1, 0);
+  for (std::size_t i = 0; i < colours.size(); ++i)
+  {
+    offsets[colours[i] + 1]++;
+  }
+  for (std::size_t c = 0; c < numColours; ++c)
+  {
+    offsets[c + 1] += offsets[c];
+  }
+
+  //move the springs into their batches, keeping their order within a batch
+  std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+  std::vector<std::uint32_t> pointA(m_pointA.size());
+  std::vector<std::uint32_t> pointB(m_pointB.size());
+  std::vector<std::uint8_t> material(m_material.size());
+  for (std::size_t i = 0; i < colours.size(); ++i)
+  {
+    std::size_t index = next[colours[i]]++;
+    pointA[index] = m_pointA[i];
+    pointB[index] = m_pointB[i];
+    material[index] = m_material[i];
+  }
+  m_pointA.swap(pointA);
+  m_pointB.swap(pointB);
+  m_material.swap(material);
+  m_colourOffsets.swap(offsets);
+}
+
+std::size_t SpringStore::getNumColours() const
+{
+  return m_colourOffsets.empty() ? 0 : m_colourOffsets.size() - 1;
+}
+
+std::size_t SpringStore::getColourBegin(std::size_t _colour) const
+{
+  return m_colourOffsets[_colour];
+}
+
+std::size_t SpringStore::getColourEnd(std::size_t _colour) const
+{
+  return m_colourOffsets[_colour + 1];
+}
+
+void SpringStore::computeForces(ParticleStore &_particles) const
+{
+  computeForces(_particles, 0, m_pointA.size());
+}
+
+void SpringStore::computeForces(ParticleStore &_particles, std::size_t _begin, std::size_t _end) const
+{
+  const float *posX = _particles.getPosX();
+  const float *posY = _particles.getPosY();
+  const float *posZ = _particles.getPosZ();
+  const float *velX = _particles.getVelX();
+  const float *velY = _particles.getVelY();
+  const float *velZ = _particles.getVelZ();
+  float *forceX = _particles.getForceX();
+  float *forceY = _particles.getForceY();
+  float *forceZ = _particles.getForceZ();
+
+  for (std::size_t i = _begin; i < _end; ++i)
+  {
+    std::uint32_t a = m_pointA[i];
+    std::uint32_t b = m_pointB[i];
+    std::uint8_t material = m_material[i];
+
+    //the vector from point a to point b
+    float dx = posX[b] - posX[a];
+    float dy = posY[b] - posY[a];
+    float dz = posZ[b] - posZ[a];
+
+    //calculate the force of the spring, the direction is normalised using the same length
+    float springLength = std::sqrt((dx * dx) + (dy * dy) + (dz * dz));
+    float springForceScale = (-m_materialStiffness[material] * (springLength - m_materialRestLength[material])) / springLength;
+    float fx = dx * springForceScale;
+    float fy = dy * springForceScale;
+    float fz = dz * springForceScale;
+
+    //point a takes the force as - and point b as +
+    forceX[a] += -fx - (m_damping * velX[a]);
+    forceY[a] += -fy - (m_damping * velY[a]);
+    forceZ[a] += -fz - (m_damping * velZ[a]);
+    forceX[b] += fx - (m_damping * velX[b]);
+    forceY[b] += fy - (m_damping * velY[b]);
+    forceZ[b] += fz - (m_damping * velZ[b]);
+  }
+}
+
+std::uint8_t SpringStore::findMaterial(float _stiffness, float _restLength)
+{
+  for (std::size_t i = 0; i < m_materialStiffness.size(); ++i)
+  {
+    if (m_materialStiffness[i] == _stiffness && m_materialRestLength[i] == _restLength)
+    {
+      return std::uint8_t(i);
+    }
+  }
+  return addMaterial(_stiffness, _restLength);
+}
+
+void SpringStore::setMaterialValue(std::vector<float> &_values, std::vector<float> &_ratios, std::size_t _material,
+                                   float _value)
+{
+  _values[_material] = _value;
+  if (_material == 0)
+  {
+    //the other materials keep their values so their ratios are to the new first value
+    if (_value != 0.0f)
+    {
+      for (std::size_t i = 1; i < _values.size(); ++i)
+      {
+        _ratios[i] = _values[i] / _value;
+      }
+    }
+  }
+  else if (_values[0] != 0.0f)
+  {
+    _ratios[_material] = _value / _values[0];
+  }
+}
+
+void SpringStore::scaleMaterials(std::vector<float> &_values, const std::vector<float> &_ratios, float _value)
+{
+  //the values come from the fixed ratios rather than the old values, so going through zero does not lose them
+  for (std::size_t i = 0; i < _values.size(); ++i)
+  {
+    _values[i] = _ratios[i] * _value;
+  }
+}
@@ -0,0 +1,44 @@
+#include "Stepper.h"
+#include "SimdKernels.h"
+
+AbstractStepper::~AbstractStepper()
+{
+}
+
+template <>
+void Stepper<Integrators::SymplecticEuler, float>::step(const SpringStore &_springs, ParticleStore &_particles, glm::vec3 _externalForce, float _dt)
+{
+  SimdKernels::computeSpringForcesParallel(_springs, _particles);
+  SimdKernels::integrateParallel(_particles, _externalForce, _dt, 0, _particles.size());
+}
+
+template <>
+void Stepper<Integrators::SymplecticEuler, float>::reset()
+{
+}
+
+std::unique_ptr<AbstractStepper> createStepper(IntegratorType _integrator, bool _doublePrecision)
+{
+  switch (_integrator)
+  {
+    case IntegratorType::VERLET:
+      if (_doublePrecision)
+      {
+        return std::unique_ptr<AbstractStepper>(new Stepper<Integrators::Verlet, double>());
+      }
+      return std::unique_ptr<AbstractStepper>(new Stepper<Integrators::Verlet, float>());
+    case IntegratorType::RK4:
+      if (_doublePrecision)
+      {
+        return std::unique_ptr<AbstractStepper>(new Stepper<Integrators::Rk4, double>());
+      }
+      return std::unique_ptr<AbstractStepper>(new Stepper<Integrators::Rk4, float>());
+    case IntegratorType::SYMPLECTIC_EULER:
+      break;
+  }
+  if (_doublePrecision)
+  {
+    return std::unique_ptr<AbstractStepper>(new Stepper<Integrators::SymplecticEuler, double>());
+  }
+  return std::unique_ptr<AbstractStepper>(new Stepper<Integrators::SymplecticEuler, float>());
+}
@@ -0,0 +1,215 @@
+#include "TaskScheduler.h"
+#include <algorithm>
+
+namespace
+{
+  ///The TaskScheduler the calling thread is a worker of.
+  thread_local const TaskScheduler *t_scheduler = nullptr;
+  ///The index of the deque of the calling thread in its TaskScheduler.
+  thread_local std::size_t t_queueIndex = 0;
+}
+
+TaskScheduler &TaskScheduler::instance()
+{
+  static TaskScheduler scheduler(0);
+  return scheduler;
+}
+
+TaskScheduler::TaskScheduler(unsigned int _numThreads) : m_numPending(0), m_stopping(false)
+{
+  startWorkers(_numThreads);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  stopWorkers();
+}
+
+unsigned int TaskScheduler::getNumThreads() const
+{
+  return unsigned(m_workers.size()) + 1;
+}
+
+void TaskScheduler::setNumThreads(unsigned int _numThreads)
+{
+  stopWorkers();
+  startWorkers(_numThreads);
+}
+
+void TaskScheduler::startWorkers(unsigned int _numThreads)
+{
+  if (_numThreads == 0)
+  {
+    _numThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  m_stopping = false;
+
+  //the shared deque for the threads that are not workers and one for each worker
+  m_queues.clear();
+  for (unsigned int i = 0; i < _numThreads; ++i)
+  {
+    m_queues.push_back(std::unique_ptr<TaskQueue>(new TaskQueue));
+  }
+
+  //the calling thread also runs tasks so it is not given a worker
+  for (unsigned int i = 1; i < _numThreads; ++i)
+  {
+    m_workers.push_back(std::thread(&TaskScheduler::workerLoop, this, std::size_t(i)));
+  }
+}
+
+void TaskScheduler::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_stopping = true;
+  }
+  m_taskAdded.notify_all();
+
+  for (auto &worker : m_workers)
+  {
+    worker.join();
+  }
+  m_workers.clear();
+}
+
+void TaskScheduler::parallelFor(std::size_t _begin, std::size_t _end, std::size_t _grainSize,
+                                const std::function<void(std::size_t, std::size_t)> &_function)
+{
+  if (_end <= _begin)
+  {
+    return;
+  }
+
+  _grainSize = std::max<std::size_t>(1, _grainSize);
+  std::size_t numChunks = (_end - _begin + _grainSize - 1) / _grainSize;
+
+  //not worth handing out, run it here
+  if (numChunks == 1 || m_workers.empty())
+  {
+    _function(_begin, _end);
+    return;
+  }
+
+  //the shared state is kept alive by the helper tasks in case they are stolen after the loop has finished
+  struct LoopState
+  {
+    std::atomic<std::size_t> m_nextChunk;
+    std::atomic<std::size_t> m_chunksLeft;
+  };
+  std::shared_ptr<LoopState> state(new LoopState);
+  state->m_nextChunk = 0;
+  state->m_chunksLeft = numChunks;
+
+  auto runChunks = [state, numChunks, _begin, _end, _grainSize, &_function]()
+  {
+    //keep taking chunks until there are none left, so threads that get through their chunks quickly take more
+    for (std::size_t chunk = state->m_nextChunk++; chunk < numChunks; chunk = state->m_nextChunk++)
+    {
+      std::size_t chunkBegin = _begin + (chunk * _grainSize);
+      std::size_t chunkEnd = std::min(_end, chunkBegin + _grainSize);
+      _function(chunkBegin, chunkEnd);
+      state->m_chunksLeft--;
+    }
+  };
+
+  //offer helpers to the other threads
+  push(runChunks, std::min(m_workers.size(), numChunks - 1));
+
+  runChunks();
+
+  //wait for the chunks other threads took, running or stealing other tasks rather than sitting idle
+  std::size_t queueIndex = getQueueIndex();
+  while (state->m_chunksLeft > 0)
+  {
+    if (!runTask(queueIndex))
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void TaskScheduler::workerLoop(std::size_t _queueIndex)
+{
+  t_scheduler = this;
+  t_queueIndex = _queueIndex;
+
+  for (;;)
+  {
+    if (runTask(_queueIndex))
+    {
+      continue;
+    }
+
+    //nothing to run or steal, sleep until a task is added
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_taskAdded.wait(lock, [this]() { return m_stopping || m_numPending > 0; });
+    if (m_stopping && m_numPending == 0)
+    {
+      return;
+    }
+  }
+}
+
+std::size_t TaskScheduler::getQueueIndex() const
+{
+  return t_scheduler == this ? t_queueIndex : 0;
+}
+
+void TaskScheduler::push(const std::function<void()> &_task, std::size_t _count)
+{
+  //the tasks are counted before they are published so a worker that takes one straight away can not take the count
+  //below zero, the sleep mutex is taken so a worker can not miss the wake up between its check and its wait
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_numPending += _count;
+  }
+
+  TaskQueue &queue = *m_queues[getQueueIndex()];
+  {
+    std::lock_guard<std::mutex> lock(queue.m_mutex);
+    for (std::size_t i = 0; i < _count; ++i)
+    {
+      queue.m_tasks.push_back(_task);
+    }
+  }
+  m_taskAdded.notify_all();
+}
+
+bool TaskScheduler::runTask(std::size_t _queueIndex)
+{
+  std::function<void()> task;
+
+  //take the newest task from the back of our own deque, this is the one most likely to be in cache
+  {
+    TaskQueue &queue = *m_queues[_queueIndex];
+    std::lock_guard<std::mutex> lock(queue.m_mutex);
+    if (!queue.m_tasks.empty())
+    {
+      task = std::move(queue.m_tasks.back());
+      queue.m_tasks.pop_back();
+    }
+  }
+
+  //steal the oldest task from the front of another deque, starting with our neighbour so thieves spread out
+  for (std::size_t i = 1; !task && i < m_queues.size(); ++i)
+  {
+    TaskQueue &victim = *m_queues[(_queueIndex + i) % m_queues.size()];
+    std::lock_guard<std::mutex> lock(victim.m_mutex);
+    if (!victim.m_tasks.empty())
+    {
+      task = std::move(victim.m_tasks.front());
+      victim.m_tasks.pop_front();
+    }
+  }
+
+  if (!task)
+  {
+    return false;
+  }
+
+  m_numPending--;
+  task();
+  return true;
+}
@@ -0,0 +1,169 @@
+#include "XpbdSolver.h"
+#include "SimdKernels.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <utility>
+
+XpbdSolver::XpbdSolver() : m_built(false), m_builtParticles(0), m_builtSprings(0), m_iterations(10), m_bendingCompliance(0.1f)
+{
+}
+
+XpbdSolver::~XpbdSolver()
+{
+}
+
+void XpbdSolver::integrate(const SpringStore &_springs, ParticleStore &_particles, glm::vec3 _externalForce, float _dt)
+{
+  if (!m_built || m_builtParticles != _particles.size() || m_builtSprings != _springs.size())
+  {
+    build(_springs, _particles);
+  }
+
+  //move the particles without the constraints, the locked particles move too and are put back by their pins
+  const float *invMass = _particles.getInvMass();
+  float damping = _springs.getDamping();
+  for (std::size_t i = 0; i < _particles.size(); ++i)
+  {
+    glm::vec3 pos = _particles.getPos(i);
+    glm::vec3 vel = _particles.getVel(i) + (_dt * invMass[i] * (_particles.getForce(i) + _externalForce));
+    vel *= std::max(0.0f, 1.0f - (_dt * invMass[i] * damping * m_numAttached[i]));
+    m_previousPositions[i] = pos;
+    _particles.setVel(i, vel);
+    _particles.setPos(i, pos + (_dt * vel));
+  }
+
+  //project each colour batch in turn, the constraints in a batch share no particles
+  TaskScheduler &scheduler = TaskScheduler::instance();
+  auto solveBatch = [&scheduler](std::size_t _begin, std::size_t _end, const std::function<void(std::size_t, std::size_t)> &_solve)
+  {
+    if (_end - _begin < SimdKernels::c_parallelThreshold)
+    {
+      _solve(_begin, _end);
+    }
+    else
+    {
+      scheduler.parallelFor(_begin, _end, SimdKernels::c_parallelGrainSize, _solve);
+    }
+  };
+  auto solveDistances = [this, &_particles, _dt](std::size_t _begin, std::size_t _end)
+  {
+    m_constraints.solveDistances(_particles, _dt, _begin, _end);
+  };
+  auto solveBendings = [this, &_particles, _dt](std::size_t _begin, std::size_t _end)
+  {
+    m_constraints.solveBendings(_particles, _dt, _begin, _end);
+  };
+
+  m_constraints.resetLambdas();
+  for (unsigned int iteration = 0; iteration < m_iterations; ++iteration)
+  {
+    for (std::size_t colour = 0; colour < m_constraints.getNumDistanceColours(); ++colour)
+    {
+      solveBatch(m_constraints.getDistanceColourBegin(colour), m_constraints.getDistanceColourEnd(colour), solveDistances);
+    }
+    for (std::size_t colour = 0; colour < m_constraints.getNumBendingColours(); ++colour)
+    {
+      solveBatch(m_constraints.getBendingColourBegin(colour), m_constraints.getBendingColourEnd(colour), solveBendings);
+    }
+    m_constraints.solvePins(_particles, _dt);
+  }
+
+  //the velocity is the distance moved over the step
+  for (std::size_t i = 0; i < _particles.size(); ++i)
+  {
+    _particles.setVel(i, (_particles.getPos(i) - m_previousPositions[i]) / _dt);
+  }
+}
+
+void XpbdSolver::invalidate()
+{
+  m_built = false;
+}
+
+void XpbdSolver::setIterations(unsigned int _iterations)
+{
+  m_iterations = _iterations;
+}
+
+unsigned int XpbdSolver::getIterations() const
+{
+  return m_iterations;
+}
+
+void XpbdSolver::setPoints(const std::vector<std::uint32_t> &_points)
+{
+  m_points = _points;
+  m_built = false;
+}
+
+void XpbdSolver::setBendingCompliance(float _compliance)
+{
+  m_bendingCompliance = _compliance;
+  m_constraints.setBendingCompliance(_compliance);
+}
+
+const ConstraintStore &XpbdSolver::getConstraints() const
+{
+  return m_constraints;
+}
+
+void XpbdSolver::build(const SpringStore &_springs, const ParticleStore &_particles)
+{
+  std::size_t numParticles = _particles.size();
+  m_constraints.clear();
+  m_numAttached.assign(numParticles, 0.0f);
+  m_previousPositions.resize(numParticles);
+
+  //the steps are taken between the points of the grid, in any order but row major neighbouring particle indices do not
+  //step evenly across the grid
+  bool usePoints = (m_points.size() == numParticles);
+  auto getPoint = [this, usePoints](std::uint32_t _particle)
+  {
+    return std::int64_t(usePoints ? m_points[_particle] : _particle);
+  };
+
+  //each spring keeps its points at its rest length
+  //the springs leaving each point are kept with the step between their grid points for the bending
+  std::vector<std::vector<std::pair<std::int64_t, std::uint32_t>>> outgoing(numParticles);
+  for (std::size_t i = 0; i < _springs.size(); ++i)
+  {
+    std::uint32_t a = _springs.getPointA(i);
+    std::uint32_t b = _springs.getPointB(i);
+    float stiffness = _springs.getStiffness(i);
+    m_constraints.addDistance(a, b, _springs.getRestLength(i), (stiffness > 0.0f) ? 1.0f / stiffness : 0.0f);
+    m_numAttached[a] += 1.0f;
+    m_numAttached[b] += 1.0f;
+    outgoing[a].push_back(std::make_pair(getPoint(a) - getPoint(b), b));
+  }
+
+  //two springs that carry on in the same step through the grid are a straight run, so they get a bending constraint
+  //that keeps the middle point in line
+  for (std::size_t i = 0; i < _springs.size(); ++i)
+  {
+    std::uint32_t a = _springs.getPointA(i);
+    std::uint32_t b = _springs.getPointB(i);
+    std::int64_t step = getPoint(a) - getPoint(b);
+    for (auto next : outgoing[b])
+    {
+      if (next.first == step)
+      {
+        m_constraints.addBending(a, b, next.second, 0.0f, m_bendingCompliance);
+      }
+    }
+  }
+
+  //the locked particles are held by rigid pins
+  for (std::size_t i = 0; i < numParticles; ++i)
+  {
+    if (_particles.getIsLocked(i))
+    {
+      m_constraints.addPin(std::uint32_t(i), _particles.getPos(i), 0.0f);
+    }
+  }
+
+  m_constraints.buildColourBatches();
+
+  m_built = true;
+  m_builtParticles = numParticles;
+  m_builtSprings = _springs.size();
+}
@@ -6,7 +6,22 @@ TARGET=Tests
 SOURCES += \
     main.cpp \
     ../Masters_Project_Silk_Torch/src/Logging.cpp \
-    ../Masters_Project_Silk_Torch/src/Utilities.cpp
+    ../Masters_Project_Silk_Torch/src/Utilities.cpp \
+    ../Masters_Project_Silk_Torch/src/ParticleStore.cpp \
+    ../Masters_Project_Silk_Torch/src/SpringStore.cpp \
+    ../Masters_Project_Silk_Torch/src/SimdKernels.cpp \
+    ../Masters_Project_Silk_Torch/src/TaskScheduler.cpp \
+    ../Masters_Project_Silk_Torch/src/ImplicitSolver.cpp \
+    ../Masters_Project_Silk_Torch/src/BandedCholesky.cpp \
+    ../Masters_Project_Silk_Torch/src/ProjectiveSolver.cpp \
+    ../Masters_Project_Silk_Torch/src/ConstraintStore.cpp \
+    ../Masters_Project_Silk_Torch/src/XpbdSolver.cpp \
+    ../Masters_Project_Silk_Torch/src/Stepper.cpp \
+    ../Masters_Project_Silk_Torch/src/FixedStepClock.cpp \
+    ../Masters_Project_Silk_Torch/src/AdaptiveStepController.cpp \
+    ../Masters_Project_Silk_Torch/src/GridStencil.cpp \
+    ../Masters_Project_Silk_Torch/src/MeshIndices.cpp \
+    ../Masters_Project_Silk_Torch/src/GridOrdering.cpp
 
 INCLUDEPATH += \
     ../Masters_Project_Silk_Torch/include
@@ -2,6 +2,25 @@
 
 #include "Logging.h"
 #include "Utilities.h"
+#include "ParticleStore.h"
+#include "SpringStore.h"
+#include "SimdKernels.h"
+#include "TaskScheduler.h"
+#include "ImplicitSolver.h"
+#include "BandedCholesky.h"
+#include "ProjectiveSolver.h"
+#include "XpbdSolver.h"
+#include "Stepper.h"
+#include "FixedStepClock.h"
+#include "AdaptiveStepController.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+#include "GridStencil.h"
+#include "MeshIndices.h"
+#include "GridOrdering.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 int main(int argc, char **argv)
 {
@@ -33,3 +52,860 @@ TEST(CustomDefs,NormaliseFloat)
 
   EXPECT_FLOAT_EQ(Utilities::normaliseFloat(num,max,min), 0.5f);
 }
+
+/*PARTICLE STORE FUNCTIONS**********************************************************/
+TEST(ParticleStore,IntegrateSkipsLockedParticles)
+{
+  ParticleStore particles;
+  particles.addParticle(glm::vec3(0.0f,0.0f,0.0f), 2.0f);
+  particles.addParticle(glm::vec3(1.0f,0.0f,0.0f), 2.0f);
+  particles.lock(0);
+
+  particles.addForce(1, glm::vec3(2.0f,0.0f,0.0f));
+  particles.integrate(glm::vec3(0.0f,4.0f,0.0f), 0.5f);
+
+  EXPECT_EQ_GLM_VEC3(particles.getPos(0), glm::vec3(0.0f,0.0f,0.0f));
+  EXPECT_EQ_GLM_VEC3(particles.getVel(1), glm::vec3(0.5f,1.0f,0.0f));
+  EXPECT_EQ_GLM_VEC3(particles.getPos(1), glm::vec3(1.25f,0.5f,0.0f));
+}
+
+/*SPRING STORE FUNCTIONS************************************************************/
+TEST(SpringStore,ComputeForcesIsEqualAndOpposite)
+{
+  ParticleStore particles;
+  particles.addParticle(glm::vec3(0.0f,0.0f,0.0f), 1.0f);
+  particles.addParticle(glm::vec3(3.0f,0.0f,0.0f), 1.0f);
+
+  SpringStore springs;
+  springs.setDamping(0.0f);
+  springs.addSpring(0, 1, 10.0f, 1.0f);
+  springs.computeForces(particles);
+
+  //the spring is stretched by 2 so both points are pulled together by 20
+  EXPECT_EQ_GLM_VEC3(particles.getForce(0), glm::vec3(20.0f,0.0f,0.0f));
+  EXPECT_EQ_GLM_VEC3(particles.getForce(1), glm::vec3(-20.0f,0.0f,0.0f));
+}
+
+TEST(SpringStore,ColourBatchesShareNoParticles)
+{
+  //a 6x6 grid of horizontal and vertical springs
+  const unsigned int gridSize = 6;
+  SpringStore springs;
+  for (unsigned int i = 0; i < gridSize * gridSize; ++i)
+  {
+    if (i % gridSize != 0)
+    {
+      springs.addSpring(i, i - 1, 1.0f, 1.0f);
+    }
+    if (i < (gridSize * gridSize) - gridSize)
+    {
+      springs.addSpring(i + gridSize, i, 1.0f, 1.0f);
+    }
+  }
+  springs.buildColourBatches();
+
+  EXPECT_EQ(springs.getNumColours(), 4u);
+  EXPECT_EQ(springs.getColourEnd(springs.getNumColours() - 1), springs.size());
+  for (std::size_t colour = 0; colour < springs.getNumColours(); ++colour)
+  {
+    std::vector<int> uses(gridSize * gridSize, 0);
+    for (std::size_t i = springs.getColourBegin(colour); i < springs.getColourEnd(colour); ++i)
+    {
+      EXPECT_EQ(++uses[springs.getPointA(i)], 1);
+      EXPECT_EQ(++uses[springs.getPointB(i)], 1);
+    }
+  }
+
+  //a particle with more springs than there are colours leaves the springs uncoloured for the serial path
+  SpringStore star;
+  for (std::uint32_t i = 1; i <= 65; ++i)
+  {
+    star.addSpring(0, i, 1.0f, 1.0f);
+  }
+  star.buildColourBatches();
+  EXPECT_EQ(star.getNumColours(), 0u);
+  EXPECT_EQ(star.size(), 65u);
+}
+
+TEST(SpringStore,ColourBatchesShareNoParticlesWithShearAndBendSprings)
+{
+  //a 6x6 grid with the diagonal and skip one springs as well, twelve springs can meet at a point
+  const int gridSize = 6;
+  const int offsets[6][2] = {{-1,0},{0,-1},{-1,-1},{1,-1},{-2,0},{0,-2}};
+  SpringStore springs;
+  for (int i = 0; i < gridSize * gridSize; ++i)
+  {
+    int x = i % gridSize;
+    int y = i / gridSize;
+    for (auto offset : offsets)
+    {
+      int otherX = x + offset[0];
+      int otherY = y + offset[1];
+      if (otherX >= 0 && otherX < gridSize && otherY >= 0)
+      {
+        springs.addSpring(std::uint32_t(i), std::uint32_t(otherY * gridSize + otherX), 1.0f, 1.0f);
+      }
+    }
+  }
+  std::size_t numSprings = springs.size();
+  springs.buildColourBatches();
+
+  EXPECT_EQ(springs.size(), numSprings);
+  EXPECT_GE(springs.getNumColours(), 12u);
+  EXPECT_EQ(springs.getColourEnd(springs.getNumColours() - 1), springs.size());
+  for (std::size_t colour = 0; colour < springs.getNumColours(); ++colour)
+  {
+    std::vector<int> uses(gridSize * gridSize, 0);
+    for (std::size_t i = springs.getColourBegin(colour); i < springs.getColourEnd(colour); ++i)
+    {
+      EXPECT_EQ(++uses[springs.getPointA(i)], 1);
+      EXPECT_EQ(++uses[springs.getPointB(i)], 1);
+    }
+  }
+}
+
+TEST(SpringStore,MaterialsAreSharedAndKeepTheirRatio)
+{
+  SpringStore springs;
+  std::uint8_t body = springs.addMaterial(10.0f, 1.0f);
+  std::uint8_t base = springs.addMaterial(40.0f, 1.0f);
+  springs.addSpring(0, 1, body);
+  springs.addSpring(1, 2, base);
+  springs.addSpring(2, 3, body);
+
+  //springs with the same values share a material
+  springs.addSpring(3, 4, 40.0f, 1.0f);
+  EXPECT_EQ(springs.getNumMaterials(), 2u);
+  EXPECT_EQ(springs.getMaterial(3), base);
+
+  //a change to a material changes every spring using it
+  springs.setMaterialStiffness(body, 20.0f);
+  EXPECT_FLOAT_EQ(springs.getStiffness(0), 20.0f);
+  EXPECT_FLOAT_EQ(springs.getStiffness(2), 20.0f);
+  EXPECT_FLOAT_EQ(springs.getStiffness(1), 40.0f);
+
+  //the overrides keep their ratio to the first material
+  springs.setStiffness(10.0f);
+  EXPECT_FLOAT_EQ(springs.getStiffness(0), 10.0f);
+  EXPECT_FLOAT_EQ(springs.getStiffness(1), 20.0f);
+  springs.setRestLength(2.0f);
+  EXPECT_FLOAT_EQ(springs.getRestLength(1), 2.0f);
+
+  //the ratios are kept when the values go through zero and back
+  std::uint8_t bend = springs.addMaterial(10.0f, 4.0f);
+  springs.setStiffness(0.0f);
+  springs.setRestLength(0.0f);
+  EXPECT_FLOAT_EQ(springs.getMaterialStiffness(base), 0.0f);
+  EXPECT_FLOAT_EQ(springs.getMaterialRestLength(bend), 0.0f);
+  springs.setStiffness(5.0f);
+  springs.setRestLength(1.0f);
+  EXPECT_FLOAT_EQ(springs.getMaterialStiffness(body), 5.0f);
+  EXPECT_FLOAT_EQ(springs.getMaterialStiffness(base), 10.0f);
+  EXPECT_FLOAT_EQ(springs.getMaterialStiffness(bend), 5.0f);
+  EXPECT_FLOAT_EQ(springs.getMaterialRestLength(base), 1.0f);
+  EXPECT_FLOAT_EQ(springs.getMaterialRestLength(bend), 2.0f);
+
+  //copies of a store keep the material indices even when two materials match
+  SpringStore copy;
+  copy.addMaterial(5.0f, 1.0f);
+  copy.addMaterial(5.0f, 1.0f);
+  copy.addSpring(0, 1, std::uint8_t(1));
+  SpringStore batch;
+  batch.append(copy, 0);
+  batch.append(copy, 2);
+  EXPECT_EQ(batch.getNumMaterials(), 2u);
+  EXPECT_EQ(batch.getMaterial(0), 1u);
+  EXPECT_EQ(batch.getMaterial(1), 1u);
+}
+
+/*SIMD KERNEL FUNCTIONS*************************************************************/
+TEST(SimdKernels,MatchScalarKernels)
+{
+  //a stretched strip of points with the first few locked, long enough to use every vector width and a tail, with
+  //the springs spread over a few materials so the kernels look them up
+  ParticleStore reference;
+  SpringStore springs;
+  for (unsigned int i = 0; i < 37; ++i)
+  {
+    reference.addParticle(glm::vec3(float(i) * 1.5f, float(i % 3) * 0.25f, 0.0f), 2.0f);
+    if (i % 7 == 0)
+    {
+      reference.lock(i);
+    }
+    if (i > 0)
+    {
+      springs.addSpring(i, i - 1, 50.0f + float(i % 3) * 20.0f, 1.0f + float(i % 2) * 0.5f);
+    }
+  }
+  springs.setDamping(0.2f);
+  glm::vec3 external(1.0f, 10.0f, -5.0f);
+
+  ParticleStore expected = reference;
+  springs.computeForces(expected);
+  expected.integrate(external, 0.01f);
+
+  SimdKernels::Isa detected = SimdKernels::getDetectedIsa();
+  for (int isa = int(SimdKernels::Isa::SCALAR); isa <= int(detected); ++isa)
+  {
+    SimdKernels::setIsa(SimdKernels::Isa(isa));
+    ParticleStore actual = reference;
+    SimdKernels::computeSpringForces(springs, actual, 0, springs.size());
+    SimdKernels::integrate(actual, external, 0.01f, 0, actual.size());
+
+    for (unsigned int i = 0; i < actual.size(); ++i)
+    {
+      EXPECT_NEAR(actual.getPos(i).x, expected.getPos(i).x, 1e-4f);
+      EXPECT_NEAR(actual.getPos(i).y, expected.getPos(i).y, 1e-4f);
+      EXPECT_NEAR(actual.getVel(i).x, expected.getVel(i).x, 1e-3f);
+      EXPECT_NEAR(actual.getVel(i).y, expected.getVel(i).y, 1e-3f);
+    }
+  }
+  SimdKernels::setIsa(detected);
+}
+
+/*TASK SCHEDULER FUNCTIONS**********************************************************/
+TEST(TaskScheduler,NestedParallelForCoversRange)
+{
+  TaskScheduler scheduler(4);
+  std::atomic<std::size_t> total(0);
+
+  //an outer loop of uneven inner loops, like flames of different grid sizes
+  scheduler.parallelFor(0, 16, 1, [&](std::size_t _begin, std::size_t _end)
+  {
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      scheduler.parallelFor(0, 1000 * (i + 1), 100, [&](std::size_t _innerBegin, std::size_t _innerEnd)
+      {
+        total += _innerEnd - _innerBegin;
+      });
+    }
+  });
+
+  EXPECT_EQ(total, std::size_t(1000 * 16 * 17 / 2));
+  scheduler.setNumThreads(2);
+  EXPECT_EQ(scheduler.getNumThreads(), 2u);
+}
+
+/*IMPLICIT SOLVER FUNCTIONS*********************************************************/
+TEST(ImplicitSolver,StiffChainStaysStable)
+{
+  //a hanging chain with springs far too stiff for the explicit integration at 30Hz
+  ParticleStore particles;
+  SpringStore springs;
+  for (unsigned int i = 0; i < 10; ++i)
+  {
+    particles.addParticle(glm::vec3(float(i),0.0f,0.0f), 1.0f);
+    if (i > 0)
+    {
+      springs.addSpring(i - 1, i, 100000.0f, 1.0f);
+    }
+  }
+  particles.lock(0);
+
+  ImplicitSolver solver;
+  for (int step = 0; step < 300; ++step)
+  {
+    particles.clearForces();
+    springs.computeForces(particles);
+    solver.integrate(springs, particles, glm::vec3(0.0f,-10.0f,0.0f), 1.0f / 30.0f);
+  }
+
+  //the chain swings under gravity without stretching or blowing up
+  EXPECT_GT(glm::length(particles.getPos(9)), 8.5f);
+  EXPECT_LT(glm::length(particles.getPos(9)), 9.1f);
+  EXPECT_LT(particles.getPos(9).y, 0.0f);
+  EXPECT_LE(solver.getLastIterations(), solver.getMaxIterations());
+}
+
+/*BANDED CHOLESKY FUNCTIONS*********************************************************/
+TEST(BandedCholesky,SolvesTridiagonalSystem)
+{
+  //the 1D Laplacian plus the identity
+  BandedCholesky matrix;
+  matrix.resize(5, 1);
+  for (std::size_t i = 0; i < 5; ++i)
+  {
+    matrix.add(i, i, 3.0);
+    if (i > 0)
+    {
+      matrix.add(i, i - 1, -1.0);
+    }
+  }
+  ASSERT_TRUE(matrix.factorise());
+
+  //the right hand side of the solution 1, 2, 3, 4, 5
+  std::vector<double> x = {1.0, 2.0, 3.0, 4.0, 11.0};
+  matrix.solve(x);
+  for (std::size_t i = 0; i < 5; ++i)
+  {
+    EXPECT_NEAR(x[i], double(i + 1), 1e-9);
+  }
+}
+
+/*PROJECTIVE SOLVER FUNCTIONS*******************************************************/
+TEST(ProjectiveSolver,StiffChainReusesFactor)
+{
+  ParticleStore particles;
+  SpringStore springs;
+  for (unsigned int i = 0; i < 10; ++i)
+  {
+    particles.addParticle(glm::vec3(float(i),0.0f,0.0f), 1.0f);
+    if (i > 0)
+    {
+      springs.addSpring(i - 1, i, 100000.0f, 1.0f);
+    }
+  }
+  particles.lock(0);
+
+  //the chain swings a long way each step so it needs more iterations than a flame
+  ProjectiveSolver solver;
+  solver.setIterations(50);
+  for (int step = 0; step < 300; ++step)
+  {
+    particles.clearForces();
+    solver.integrate(springs, particles, glm::vec3(0.0f,-10.0f,0.0f), 1.0f / 30.0f);
+  }
+
+  //the chain swings under gravity without stretching and the matrix is only factored once
+  EXPECT_GT(glm::length(particles.getPos(9)), 8.5f);
+  EXPECT_LT(glm::length(particles.getPos(9)), 9.1f);
+  EXPECT_LT(particles.getPos(9).y, 0.0f);
+  EXPECT_EQ(solver.getNumFactorisations(), 1u);
+  EXPECT_EQ(solver.getBandwidth(), 1u);
+}
+
+/*XPBD SOLVER FUNCTIONS*************************************************************/
+TEST(XpbdSolver,StiffChainHangsFromPin)
+{
+  ParticleStore particles;
+  SpringStore springs;
+  for (unsigned int i = 0; i < 10; ++i)
+  {
+    particles.addParticle(glm::vec3(float(i),0.0f,0.0f), 1.0f);
+    if (i > 0)
+    {
+      springs.addSpring(i, i - 1, 100000.0f, 1.0f);
+    }
+  }
+  particles.lock(0);
+
+  XpbdSolver solver;
+  solver.setIterations(20);
+  for (int step = 0; step < 300; ++step)
+  {
+    particles.clearForces();
+    solver.integrate(springs, particles, glm::vec3(0.0f,-10.0f,0.0f), 1.0f / 30.0f);
+  }
+
+  //the straight runs of springs get bending constraints and the locked point gets a pin
+  EXPECT_EQ(solver.getConstraints().getNumDistances(), 9u);
+  EXPECT_EQ(solver.getConstraints().getNumBendings(), 8u);
+  EXPECT_EQ(solver.getConstraints().getNumPins(), 1u);
+
+  //the pinned point stays put and the chain swings without stretching
+  EXPECT_EQ_GLM_VEC3(particles.getPos(0), glm::vec3(0.0f,0.0f,0.0f));
+  EXPECT_LT(glm::length(particles.getPos(9)), 9.1f);
+  EXPECT_LT(particles.getPos(9).y, 0.0f);
+}
+
+TEST(XpbdSolver,BendingRunsMatchAcrossParticleOrders)
+{
+  //the same grid of structural springs stored in each order
+  auto countBendings = [](ParticleOrder _order)
+  {
+    const unsigned int gridSize = 12;
+    GridOrdering ordering;
+    ordering.build(gridSize, _order);
+    ParticleStore particles;
+    SpringStore springs;
+    for (std::size_t i = 0; i < ordering.getPoints().size(); ++i)
+    {
+      std::uint32_t point = ordering.getPoint(i);
+      particles.addParticle(glm::vec3(float(point % gridSize),float(point / gridSize),0.0f), 1.0f);
+    }
+    for (unsigned int y = 0; y < gridSize; ++y)
+    {
+      for (unsigned int x = 0; x < gridSize; ++x)
+      {
+        if (x > 0)
+        {
+          springs.addSpring(ordering.getIndex(x, y), ordering.getIndex(x - 1, y), 1000.0f, 1.0f);
+        }
+        if (y > 0)
+        {
+          springs.addSpring(ordering.getIndex(x, y), ordering.getIndex(x, y - 1), 1000.0f, 1.0f);
+        }
+      }
+    }
+
+    XpbdSolver solver;
+    solver.setPoints(ordering.getPoints());
+    solver.integrate(springs, particles, glm::vec3(0.0f), 1.0f / 30.0f);
+    return solver.getConstraints().getNumBendings();
+  };
+
+  //every row and column of 12 points has 10 straight runs whatever order the particles are in
+  EXPECT_EQ(countBendings(ParticleOrder::ROW_MAJOR), 2u * 12u * 10u);
+  EXPECT_EQ(countBendings(ParticleOrder::MORTON), countBendings(ParticleOrder::ROW_MAJOR));
+  EXPECT_EQ(countBendings(ParticleOrder::TILED), countBendings(ParticleOrder::ROW_MAJOR));
+}
+
+/*STEPPER FUNCTIONS*****************************************************************/
+TEST(Stepper,HigherOrderIntegratorsAreMoreAccurate)
+{
+  //a mass on a spring from a locked point, stepped for one second
+  auto run = [](IntegratorType _integrator, bool _doublePrecision, int _numSteps)
+  {
+    ParticleStore particles;
+    particles.addParticle(glm::vec3(0.0f,0.0f,0.0f), 1.0f);
+    particles.addParticle(glm::vec3(1.5f,0.0f,0.0f), 1.0f);
+    particles.lock(0);
+    SpringStore springs;
+    springs.addSpring(0, 1, 100.0f, 1.0f);
+
+    std::unique_ptr<AbstractStepper> stepper = createStepper(_integrator, _doublePrecision);
+    for (int step = 0; step < _numSteps; ++step)
+    {
+      particles.clearForces();
+      stepper->step(springs, particles, glm::vec3(0.0f,-1.0f,0.0f), 1.0f / float(_numSteps));
+    }
+    return particles.getPos(1);
+  };
+
+  glm::vec3 reference = run(IntegratorType::RK4, true, 10000);
+  float eulerError = glm::length(run(IntegratorType::SYMPLECTIC_EULER, true, 100) - reference);
+  float verletError = glm::length(run(IntegratorType::VERLET, true, 100) - reference);
+  float rk4Error = glm::length(run(IntegratorType::RK4, true, 100) - reference);
+  EXPECT_LT(verletError, eulerError);
+  EXPECT_LT(rk4Error, verletError);
+
+  //the float symplectic Euler uses the SimdKernels but gives the same result as the double stepper
+  EXPECT_NEAR(glm::length(run(IntegratorType::SYMPLECTIC_EULER, false, 100) - reference), eulerError, 1e-3f);
+}
+
+TEST(Stepper,VerletFollowsAChangedExternalForce)
+{
+  //a mass on a spring from a locked point, the force changes between steps like the wind impulse does
+  auto run = [](bool _reset)
+  {
+    ParticleStore particles;
+    particles.addParticle(glm::vec3(0.0f,0.0f,0.0f), 1.0f);
+    particles.addParticle(glm::vec3(1.5f,0.0f,0.0f), 1.0f);
+    particles.lock(0);
+    SpringStore springs;
+    springs.addSpring(0, 1, 100.0f, 1.0f);
+
+    std::unique_ptr<AbstractStepper> stepper = createStepper(IntegratorType::VERLET, false);
+    particles.clearForces();
+    stepper->step(springs, particles, glm::vec3(0.0f,-1.0f,0.0f), 0.01f);
+    if (_reset)
+    {
+      stepper->reset();
+    }
+    particles.clearForces();
+    stepper->step(springs, particles, glm::vec3(0.0f,0.0f,-5.0f), 0.01f);
+    return particles.getPos(1);
+  };
+
+  //the kept acceleration has to be dropped so the step matches a stepper that starts again
+  glm::vec3 kept = run(false);
+  glm::vec3 reset = run(true);
+  EXPECT_FLOAT_EQ(kept.x, reset.x);
+  EXPECT_FLOAT_EQ(kept.y, reset.y);
+  EXPECT_FLOAT_EQ(kept.z, reset.z);
+}
+
+/*FIXED STEP CLOCK FUNCTIONS********************************************************/
+TEST(FixedStepClock,StepsAtFixedRateAndCapsCatchUp)
+{
+  FixedStepClock clock(0.01f, 4);
+
+  //short frames build up until a whole step is covered
+  EXPECT_EQ(clock.advance(0.004f), 0u);
+  EXPECT_NEAR(clock.getAlpha(), 0.4f, 1e-4f);
+  EXPECT_EQ(clock.advance(0.008f), 1u);
+  EXPECT_NEAR(clock.getAlpha(), 0.2f, 1e-4f);
+
+  //a long frame takes several steps
+  EXPECT_EQ(clock.advance(0.03f), 3u);
+  EXPECT_EQ(clock.getNumDroppedFrames(), 0u);
+
+  //a stall only takes the capped number of steps and drops the rest
+  EXPECT_EQ(clock.advance(1.0f), 4u);
+  EXPECT_EQ(clock.getNumDroppedFrames(), 1u);
+  EXPECT_LT(clock.getAlpha(), 1.0f);
+  EXPECT_EQ(clock.advance(0.0f), 0u);
+}
+
+/*ADAPTIVE STEP CONTROLLER FUNCTIONS************************************************/
+TEST(AdaptiveStepController,SubstepsOnlyStiffOrFastSteps)
+{
+  //a hanging chain of 10 points
+  auto makeChain = [](ParticleStore &_particles, SpringStore &_springs, float _k)
+  {
+    for (int i = 0; i < 10; ++i)
+    {
+      _particles.addParticle(glm::vec3(0.0f,-float(i),0.0f), 1.0f);
+    }
+    _particles.lock(0);
+    for (std::uint32_t i = 0; i < 9; ++i)
+    {
+      _springs.addSpring(i, i + 1, _k, 1.0f);
+    }
+    _springs.setDamping(0.1f);
+  };
+  const float dt = 1.0f / 60.0f;
+
+  //a soft chain at rest takes one step
+  ParticleStore particles;
+  SpringStore springs;
+  makeChain(particles, springs, 100.0f);
+  AdaptiveStepController controller;
+  EXPECT_EQ(controller.computeNumSubsteps(springs, particles, glm::vec3(0.0f,-1.0f,0.0f), dt), 1u);
+
+  //a fast particle is split so it moves less than a quarter of a spring per substep
+  particles.setVel(9, glm::vec3(100.0f,0.0f,0.0f));
+  unsigned int numSubsteps = controller.computeNumSubsteps(springs, particles, glm::vec3(0.0f), dt);
+  EXPECT_GT(numSubsteps, 1u);
+  EXPECT_LE(100.0f * dt / float(numSubsteps), 0.25f);
+
+  //a stiff chain that blows up in one step stays bounded with the substeps
+  ParticleStore stiffParticles;
+  SpringStore stiffSprings;
+  makeChain(stiffParticles, stiffSprings, 1e5f);
+  stiffParticles.setPos(9, glm::vec3(0.0f,-9.5f,0.0f));
+  AdaptiveStepController stiffController;
+  std::unique_ptr<AbstractStepper> stepper = createStepper(IntegratorType::SYMPLECTIC_EULER, false);
+  for (int step = 0; step < 120; ++step)
+  {
+    stiffParticles.clearForces();
+    numSubsteps = stiffController.computeNumSubsteps(stiffSprings, stiffParticles, glm::vec3(0.0f,-1.0f,0.0f), dt);
+    for (unsigned int i = 0; i < numSubsteps; ++i)
+    {
+      stiffParticles.clearForces();
+      stepper->step(stiffSprings, stiffParticles, glm::vec3(0.0f,-1.0f,0.0f), dt / float(numSubsteps));
+    }
+  }
+  EXPECT_GT(stiffController.getNumSubsteps(), 1u);
+  EXPECT_LT(glm::length(stiffParticles.getPos(9) - glm::vec3(0.0f,-9.0f,0.0f)), 1.0f);
+}
+
+/*TRIPLE BUFFER FUNCTIONS***********************************************************/
+TEST(TripleBuffer,ReaderOnlySeesWholePublishedValues)
+{
+  TripleBuffer<std::vector<int>> buffer;
+  EXPECT_FALSE(buffer.update());
+
+  //the writer fills every element with the same number so a torn value would show up as a mix
+  const int numValues = 20000;
+  std::thread writer([&buffer, numValues]()
+  {
+    for (int value = 1; value <= numValues; ++value)
+    {
+      std::vector<int> &back = buffer.getWriteBuffer();
+      back.assign(64, value);
+      buffer.publish();
+    }
+  });
+
+  int lastValue = 0;
+  while (lastValue < numValues)
+  {
+    if (buffer.update())
+    {
+      const std::vector<int> &front = buffer.getReadBuffer();
+      ASSERT_EQ(front.size(), 64u);
+      for (int element : front)
+      {
+        ASSERT_EQ(element, front[0]);
+      }
+      //the values only move forward, some are skipped
+      EXPECT_GT(front[0], lastValue);
+      lastValue = front[0];
+    }
+  }
+  writer.join();
+  EXPECT_FALSE(buffer.update());
+}
+
+/*SPSC QUEUE FUNCTIONS**************************************************************/
+TEST(SpscQueue,KeepsOrderAcrossThreads)
+{
+  SpscQueue<int> queue(100);
+  EXPECT_EQ(queue.capacity(), 128u);
+
+  //a full queue turns values away
+  for (int i = 0; i < 128; ++i)
+  {
+    EXPECT_TRUE(queue.push(i));
+  }
+  EXPECT_FALSE(queue.push(128));
+  int value = -1;
+  for (int i = 0; i < 128; ++i)
+  {
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.pop(value));
+
+  //every value arrives once and in order when the threads race
+  const int numValues = 100000;
+  std::thread producer([&queue, numValues]()
+  {
+    for (int i = 0; i < numValues; ++i)
+    {
+      while (!queue.push(i))
+      {
+        std::this_thread::yield();
+      }
+    }
+  });
+  int expected = 0;
+  while (expected < numValues)
+  {
+    if (queue.pop(value))
+    {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_FALSE(queue.pop(value));
+}
+
+/*GRID STENCIL FUNCTIONS************************************************************/
+TEST(GridStencil,MatchesSpringStore)
+{
+  //two bent 6x6 grids one after the other with a stiffer base, every kind of spring in the stencil is also added to
+  //the SpringStore
+  const unsigned int gridSize = 6;
+  const unsigned int baseRows = 2;
+  ParticleStore reference;
+  SpringStore springs;
+  springs.setDamping(0.3f);
+  for (unsigned int grid = 0; grid < 2; ++grid)
+  {
+    for (unsigned int i = 0; i < gridSize * gridSize; ++i)
+    {
+      float x = float(i % gridSize);
+      float y = float(i / gridSize);
+      std::size_t index = reference.addParticle(glm::vec3(x * 1.1f, y * 0.9f, std::sin(x + y + float(grid))), 1.0f);
+      reference.setVel(index, glm::vec3(0.1f * x, -0.2f, 0.05f * y));
+    }
+  }
+  const int offsets[6][2] = {{1,0},{0,1},{1,1},{-1,1},{2,0},{0,2}};
+  const float restLengths[6] = {1.0f, 1.0f, std::sqrt(2.0f), std::sqrt(2.0f), 2.0f, 2.0f};
+  for (unsigned int grid = 0; grid < 2; ++grid)
+  {
+    for (int y = 0; y < int(gridSize); ++y)
+    {
+      for (int x = 0; x < int(gridSize); ++x)
+      {
+        for (int j = 0; j < 6; ++j)
+        {
+          int otherX = x + offsets[j][0];
+          int otherY = y + offsets[j][1];
+          if (otherX < 0 || otherX >= int(gridSize) || otherY >= int(gridSize))
+          {
+            continue;
+          }
+          float stiffness = (otherY < int(baseRows)) ? 30.0f : 10.0f;
+          std::uint32_t first = grid * gridSize * gridSize;
+          springs.addSpring(first + std::uint32_t(y * int(gridSize) + x), first + std::uint32_t(otherY * int(gridSize) + otherX),
+                            stiffness, restLengths[j]);
+        }
+      }
+    }
+  }
+
+  GridStencil stencil;
+  stencil.setGrid(gridSize, 2);
+  stencil.setStiffness(10.0f);
+  stencil.setBaseStiffness(3.0f, baseRows);
+  stencil.setRestLength(1.0f);
+  stencil.setDamping(0.3f);
+  stencil.setSprings(true, true);
+
+  ParticleStore expected = reference;
+  springs.computeForces(expected);
+  ParticleStore actual = reference;
+  stencil.computeForcesParallel(actual);
+  for (unsigned int i = 0; i < actual.size(); ++i)
+  {
+    EXPECT_NEAR(actual.getForce(i).x, expected.getForce(i).x, 1e-3f);
+    EXPECT_NEAR(actual.getForce(i).y, expected.getForce(i).y, 1e-3f);
+    EXPECT_NEAR(actual.getForce(i).z, expected.getForce(i).z, 1e-3f);
+  }
+
+  //the stiffness sums give the same substeps as the springs
+  AdaptiveStepController fromSprings;
+  AdaptiveStepController fromStencil;
+  EXPECT_EQ(fromStencil.computeNumSubsteps(stencil, reference, glm::vec3(0.0f), 0.5f),
+            fromSprings.computeNumSubsteps(springs, reference, glm::vec3(0.0f), 0.5f));
+  EXPECT_FLOAT_EQ(fromStencil.getStableDt(), fromSprings.getStableDt());
+}
+
+TEST(GridStencil,BlockedSubstepsMatchSubsteps)
+{
+  //four 24x24 grids with their bottom rows locked, each pushed by its own external force
+  const unsigned int gridSize = 24;
+  const unsigned int numGrids = 4;
+  ParticleStore start;
+  for (unsigned int grid = 0; grid < numGrids; ++grid)
+  {
+    for (unsigned int i = 0; i < gridSize * gridSize; ++i)
+    {
+      float x = float(i % gridSize);
+      float y = float(i / gridSize);
+      std::size_t index = start.addParticle(glm::vec3(x, y * 1.05f, 0.2f * std::sin(x + y + float(grid))), 2.0f);
+      start.setVel(index, glm::vec3(0.0f, 0.1f * float(grid), 0.0f));
+      if (i < gridSize)
+      {
+        start.lock(index);
+      }
+    }
+  }
+  std::vector<glm::vec3> externalForces = {glm::vec3(1.0f, 5.0f, 0.0f), glm::vec3(0.0f, 10.0f, -3.0f),
+                                           glm::vec3(-2.0f, 0.0f, 1.0f), glm::vec3(0.0f, 2.0f, 2.0f)};
+
+  for (bool bend : {false, true})
+  {
+    GridStencil stencil;
+    stencil.setGrid(gridSize, numGrids);
+    stencil.setStiffness(50.0f);
+    stencil.setBaseStiffness(2.0f, 2);
+    stencil.setDamping(0.2f);
+    stencil.setSprings(true, bend);
+    //the smallest bands so the rows around them cross between the bands and the grids
+    stencil.setTileSize(0);
+
+    //seven substeps are stepped as four then three
+    const unsigned int numSubsteps = 7;
+    const float dt = 0.005f;
+    ParticleStore expected = start;
+    for (unsigned int substep = 0; substep < numSubsteps; ++substep)
+    {
+      expected.clearForces();
+      stencil.computeForces(expected);
+      for (unsigned int grid = 0; grid < numGrids; ++grid)
+      {
+        SimdKernels::integrate(expected, externalForces[grid], dt, grid * gridSize * gridSize,
+                               (grid + 1) * gridSize * gridSize);
+      }
+    }
+    ParticleStore actual = start;
+    stencil.stepBlocked(actual, externalForces, dt, numSubsteps);
+
+    for (unsigned int i = 0; i < actual.size(); ++i)
+    {
+      EXPECT_NEAR(actual.getPos(i).x, expected.getPos(i).x, 1e-5f);
+      EXPECT_NEAR(actual.getPos(i).y, expected.getPos(i).y, 1e-5f);
+      EXPECT_NEAR(actual.getPos(i).z, expected.getPos(i).z, 1e-5f);
+      EXPECT_NEAR(actual.getVel(i).x, expected.getVel(i).x, 1e-4f);
+      EXPECT_NEAR(actual.getVel(i).y, expected.getVel(i).y, 1e-4f);
+      EXPECT_NEAR(actual.getVel(i).z, expected.getVel(i).z, 1e-4f);
+    }
+  }
+}
+
+/*MESH INDICES FUNCTIONS************************************************************/
+TEST(MeshIndices,PicksTheIndexTypeFromTheVertexCount)
+{
+  MeshIndices indices;
+  indices.reset(MeshIndices::c_maxShortVertices);
+  indices.add(0);
+  indices.add(MeshIndices::c_maxShortVertices - 1);
+  EXPECT_FALSE(indices.getIsInt());
+  EXPECT_EQ(indices.getIndexSize(), sizeof(std::uint16_t));
+  EXPECT_EQ(indices.get(1), MeshIndices::c_maxShortVertices - 1);
+
+  //a 1000x1000 grid needs 32 bit indices
+  std::size_t numVertices = 1000 * 1000;
+  indices.reset(numVertices);
+  EXPECT_TRUE(indices.empty());
+  indices.add(numVertices - 1);
+  EXPECT_TRUE(indices.getIsInt());
+  EXPECT_EQ(indices.getIndexSize(), sizeof(std::uint32_t));
+  EXPECT_EQ(indices.size(), 1u);
+  EXPECT_EQ(indices.get(0), numVertices - 1);
+  EXPECT_EQ(*static_cast<const std::uint32_t *>(indices.getData()), std::uint32_t(numVertices - 1));
+}
+
+/*GRID ORDERING FUNCTIONS***********************************************************/
+TEST(GridOrdering,OrdersKeepEveryPointAndTheirNeighboursClose)
+{
+  //a grid that does not fit whole tiles or a power of two
+  unsigned int gridSize = 37;
+  for (auto order : {ParticleOrder::ROW_MAJOR, ParticleOrder::TILED, ParticleOrder::MORTON})
+  {
+    GridOrdering ordering;
+    ordering.build(gridSize, order);
+    std::vector<int> used(gridSize * gridSize, 0);
+    for (unsigned int y = 0; y < gridSize; ++y)
+    {
+      for (unsigned int x = 0; x < gridSize; ++x)
+      {
+        std::uint32_t index = ordering.getIndex(x, y);
+        ASSERT_LT(index, gridSize * gridSize);
+        EXPECT_EQ(ordering.getPoint(index), (y * gridSize) + x);
+        ++used[index];
+      }
+    }
+    EXPECT_EQ(std::count(used.begin(), used.end(), 1), long(gridSize * gridSize));
+  }
+
+  //count the points whose vertical neighbour is within the same 256 bytes of a float array
+  gridSize = 256;
+  auto countClose = [gridSize](ParticleOrder _order)
+  {
+    GridOrdering ordering;
+    ordering.build(gridSize, _order);
+    std::size_t close = 0;
+    for (unsigned int y = 0; y + 1 < gridSize; ++y)
+    {
+      for (unsigned int x = 0; x < gridSize; ++x)
+      {
+        std::int64_t distance = std::int64_t(ordering.getIndex(x, y + 1)) - std::int64_t(ordering.getIndex(x, y));
+        if (std::abs(distance) < 64)
+        {
+          ++close;
+        }
+      }
+    }
+    return close;
+  };
+  std::size_t numVertical = (gridSize - 1) * gridSize;
+  EXPECT_EQ(countClose(ParticleOrder::ROW_MAJOR), 0u);
+  EXPECT_GT(countClose(ParticleOrder::TILED), numVertical / 2);
+  EXPECT_GT(countClose(ParticleOrder::MORTON), numVertical / 2);
+
+  //the particles keep their state when they are moved into an order
+  GridOrdering ordering;
+  ordering.build(4, ParticleOrder::MORTON);
+  ParticleStore particles;
+  for (unsigned int i = 0; i < 16; ++i)
+  {
+    particles.addParticle(glm::vec3(float(i % 4), float(i / 4), 0.0f), 1.0f + float(i));
+  }
+  particles.lock(1);
+  std::vector<std::uint32_t> moveFrom(16);
+  for (std::size_t i = 0; i < moveFrom.size(); ++i)
+  {
+    moveFrom[i] = ordering.getPoint(i);
+  }
+  particles.reorder(moveFrom);
+  for (unsigned int y = 0; y < 4; ++y)
+  {
+    for (unsigned int x = 0; x < 4; ++x)
+    {
+      std::uint32_t index = ordering.getIndex(x, y);
+      EXPECT_EQ(particles.getPos(index), glm::vec3(float(x), float(y), 0.0f));
+      EXPECT_FLOAT_EQ(particles.getMass(index), 1.0f + float((y * 4) + x));
+      EXPECT_EQ(particles.getIsLocked(index), x == 1 && y == 0);
+    }
+  }
+}